@@ -2,6 +2,7 @@
 
 #include "config/keys/he_key.hpp"
 #include "config/keys/digital_key.hpp"
+#include "config/macro.hpp"
 
 // Configuration for the whole firmware, containing the name of the keypad and it's configurations.
 struct Configuration
@@ -10,7 +11,13 @@ struct Configuration
     uint32_t version = Configuration::getVersion();
 
     // The name of the keypad, used to distinguish it from others.
-    char name[128] = "minipad";
+    char name[CONFIG_NAME_LENGTH + 1] = "minipad";
+
+    // The global brightness of the LEDs, scaling the colors of all keys. 0 turns the LEDs off.
+    uint8_t ledBrightness = 128;
+
+    // The time without any key activity after which the keypad goes idle, in seconds. 0 disables the idle mode.
+    uint16_t idleTimeout = 60;
 
     // A list of all hall effect key configurations. (rapid trigger, hysteresis, calibration, ...)
     HEKey heKeys[HE_KEYS];
@@ -18,11 +25,14 @@ struct Configuration
     // A list of all digital key configurations. (key char, hid state, ...)
     DigitalKey digitalKeys[DIGITAL_KEYS];
 
+    // A list of all macros that can be assigned to keys. (press, release and delay steps)
+    Macro macros[MACROS];
+
     // Returns the version constant of the latest Configuration layout.
     static uint32_t getVersion()
     {
         // Version of the configuration in the format YYMMDDhhmm (e.g. 2301030040 for 12:44am on the 3rd january 2023)
-        int64_t version = 2308130046;
+        int64_t version = 2610171500;
 
         return version;
     }
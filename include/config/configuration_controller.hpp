@@ -2,6 +2,7 @@
 #pragma GCC diagnostic ignored "-Wtype-limits"
 
 #include "config/configuration.hpp"
+#include "config/persistent_configuration.hpp"
 #include "definitions.hpp"
 
 inline class ConfigurationController
@@ -15,12 +16,22 @@ public:
 
     void loadConfig();
     void saveConfig();
+    void requestSave();
+    void update();
+    bool isValid(const Configuration &config) const;
+    void pack(const Configuration &config, PersistentConfiguration &persistent) const;
+    void unpack(const PersistentConfiguration &persistent, Configuration &config) const;
+    void exportConfig(ConfigurationBlob &blob) const;
+    bool importConfig(const ConfigurationBlob &blob);
 
     Configuration config;
 
 private:
     Configuration defaultConfig;
 
+    // Bool whether a save of the configuration was requested and is waiting to be done by the background task.
+    bool savePending = false;
+
     // Default configuration loaded into the EEPROM if no configuration was saved yet. Also used to reset the keypad and calibration
     // structs that might get modified on a firmware update and have to be reset back to their default values then later on.
     Configuration getDefaultConfig()
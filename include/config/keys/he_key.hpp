@@ -27,13 +27,24 @@ struct HEKey : Key
     // The sensitivity of the rapid trigger algorithm when pressing down.
     uint16_t rapidTriggerDownSensitivity = TRAVEL_DISTANCE_IN_0_01MM / 10;
 
-    // The value below which the key is pressed and rapid trigger is active in rapid trigger mode.
-    uint16_t lowerHysteresis = (uint16_t)(TRAVEL_DISTANCE_IN_0_01MM * 0.55);
+    // The value below which the key is pressed and rapid trigger is active in rapid trigger mode. (55% of the travel distance)
+    uint16_t lowerHysteresis = TRAVEL_DISTANCE_IN_0_01MM * 55 / 100;
 
-    // The value below which the key is no longer pressed and rapid trigger is no longer active in rapid trigger mode.
-    uint16_t upperHysteresis = (uint16_t)(TRAVEL_DISTANCE_IN_0_01MM * 0.675);
+    // The value below which the key is no longer pressed and rapid trigger is no longer active in rapid trigger mode. (67.5% of the travel distance)
+    uint16_t upperHysteresis = TRAVEL_DISTANCE_IN_0_01MM * 675 / 1000;
 
-    // The value read when the keys are in rest position/all the way down.
-    uint16_t restPosition = pow(2, ANALOG_RESOLUTION) - 1; // Set to the outer boundaries in order to make
-    uint16_t downPosition = 0;                             // them overwritable by the calibration code.
+    // The color of the LED of the key in the 0xRRGGBB format. The brightness follows the travel distance of the key.
+    uint32_t color = 0xFFFFFF;
+
+    // The exponent for the amount of samples of the SMA filter of the key. (0 = 1 sample, 1 = 2 samples, 2 = 4 samples, ...)
+    uint8_t smaExponent = SMA_FILTER_SAMPLE_EXPONENT;
 };
+
+// Validate the definitions the default values above are calculated from at compile time, so invalid defaults are never
+// loaded onto a keypad. The same conditions are checked by the configuration controller for loaded configurations.
+static_assert(ANALOG_RESOLUTION >= 1 && ANALOG_RESOLUTION <= 16, "ANALOG_RESOLUTION has to be between 1 and 16 bits.");
+static_assert(TRAVEL_DISTANCE_IN_0_01MM / 10 >= RAPID_TRIGGER_TOLERANCE, "The default rapid trigger sensitivities have to be at least the rapid trigger tolerance.");
+static_assert(TRAVEL_DISTANCE_IN_0_01MM * 55 / 100 + HYSTERESIS_TOLERANCE <= TRAVEL_DISTANCE_IN_0_01MM * 675 / 1000,
+              "The default lower hysteresis has to be below the default upper hysteresis by the hysteresis tolerance.");
+static_assert(TRAVEL_DISTANCE_IN_0_01MM * 675 / 1000 + HYSTERESIS_TOLERANCE <= TRAVEL_DISTANCE_IN_0_01MM,
+              "The default upper hysteresis has to be below the travel distance by the hysteresis tolerance.");
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include "config/keys/key_type.hpp"
+#include "helpers/hid_helper.hpp"
 
 // The base configuration struct for the DigitalKey and HEKey struct, containing the common fields.
 struct Key
@@ -12,6 +13,7 @@ struct Key
         type = t;
         index = i;
         keyChar = c;
+        HIDHelper::getUsage(c, &keyCode, &keyModifiers);
     }
 
     // Used to identify the type of key that a Key object was initialized as (e.g. HEKey or DigitalKey).
@@ -21,9 +23,17 @@ struct Key
     // It does not serve a config purpose but is instead for accessing the index from the DigitalKey object.
     uint8_t index;
 
-    // The corresponding key sent via HID interface.
+    // The corresponding key sent via HID interface. If 0, the key sends the usage code and modifiers below as they were set.
     char keyChar;
 
+    // The HID usage code and modifier bits sent via HID interface, compiled from the key char whenever it is set. Setting
+    // these directly allows for keys not representable by a key char and combinations with modifiers (e.g. Ctrl+C).
+    uint8_t keyCode = 0;
+    uint8_t keyModifiers = 0;
+
     // Bools whether HID commands are sent on the key.
     bool hidEnabled = true;
+
+    // The one-based index of the macro played back when the key is pressed. If 0, the key char is pressed instead.
+    uint8_t macro = 0;
 };
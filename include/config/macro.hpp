@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// An enum used to identify what a single step of a macro does.
+enum MacroStepType : uint8_t
+{
+    // Presses the key char stored in the value of the step.
+    Press,
+
+    // Releases the key char stored in the value of the step.
+    Release,
+
+    // Waits the amount of milliseconds stored in the value of the step before continuing.
+    Delay
+};
+
+// A single step of a macro, consisting of the type and the key char or delay in milliseconds, depending on the type.
+struct MacroStep
+{
+    // The type of the step. (press, release or delay)
+    MacroStepType type = MacroStepType::Press;
+
+    // The key char pressed/released or the delay in milliseconds.
+    uint16_t value = 0;
+};
+
+// Configuration for a macro, a stored sequence of steps played back when a key assigned to it is pressed.
+struct Macro
+{
+    // The amount of steps used in the steps array. A macro without any steps does nothing.
+    uint8_t length = 0;
+
+    // The steps of the macro, played back in order.
+    MacroStep steps[MACRO_STEPS];
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// The persistent format of the configuration, as it is stored in the EEPROM. It is separate from the Configuration
+// struct used at runtime, so it can be laid out explicitly without any padding and without the fields that are
+// derivable, like the type and index of the keys. The configuration controller converts between both formats.
+
+// The bits of the flags field of the persistent keys.
+#define PERSISTENT_KEY_HID_ENABLED 0x01
+#define PERSISTENT_KEY_RAPID_TRIGGER 0x02
+#define PERSISTENT_KEY_CONTINUOUS_RAPID_TRIGGER 0x04
+
+// The persistent format of a hall effect key.
+struct __attribute__((packed)) PersistentHEKey
+{
+    uint8_t flags;
+    char keyChar;
+    uint8_t keyCode;
+    uint8_t keyModifiers;
+    uint8_t macro;
+    uint8_t smaExponent;
+    uint16_t rapidTriggerUpSensitivity;
+    uint16_t rapidTriggerDownSensitivity;
+    uint16_t lowerHysteresis;
+    uint16_t upperHysteresis;
+
+    // The color of the LED of the key, stored as the red, green and blue bytes.
+    uint8_t color[3];
+};
+
+// The persistent format of a digital key.
+struct __attribute__((packed)) PersistentDigitalKey
+{
+    uint8_t flags;
+    char keyChar;
+    uint8_t keyCode;
+    uint8_t keyModifiers;
+    uint8_t macro;
+};
+
+// The persistent format of a single step of a macro.
+struct __attribute__((packed)) PersistentMacroStep
+{
+    uint8_t type;
+    uint16_t value;
+};
+
+// The persistent format of a macro.
+struct __attribute__((packed)) PersistentMacro
+{
+    uint8_t length;
+    PersistentMacroStep steps[MACRO_STEPS];
+};
+
+// The persistent format of the whole configuration.
+struct __attribute__((packed)) PersistentConfiguration
+{
+    // The version of the configuration, which is always the first field so it can be checked before anything else.
+    uint32_t version;
+
+    // The name of the keypad. Only null-terminated if it is shorter than the buffer.
+    char name[CONFIG_NAME_LENGTH];
+
+    uint8_t ledBrightness;
+    uint16_t idleTimeout;
+    PersistentHEKey heKeys[HE_KEYS];
+    PersistentDigitalKey digitalKeys[DIGITAL_KEYS];
+    PersistentMacro macros[MACROS];
+};
+
+// The persistent configuration with a CRC32 checksum, used to transfer the whole configuration between keypads.
+struct __attribute__((packed)) ConfigurationBlob
+{
+    PersistentConfiguration config;
+
+    // The CRC32 checksum of the configuration above.
+    uint32_t crc;
+};
+
+// Make sure the persistent configuration does not exceed the space reserved for it in the EEPROM.
+static_assert(sizeof(PersistentConfiguration) <= CONFIG_SIZE_BUDGET, "The persistent configuration exceeds CONFIG_SIZE_BUDGET.");
+
+// Make sure the configuration blob fits into a serial command in it's hex format, including the command name.
+static_assert(sizeof(ConfigurationBlob) * 2 + 8 < SERIAL_INPUT_BUFFER_SIZE, "The configuration blob does not fit into SERIAL_INPUT_BUFFER_SIZE.");
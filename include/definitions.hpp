@@ -39,13 +39,31 @@
 // The resolution for the ADCs on the RP2040. The theoretical maximum value on it is 16 bit (uint16_t).
 #define ANALOG_RESOLUTION 12
 
+// The highest value that can be read with the ADC resolution defined above. Calculated with a bitshift instead of
+// pow() so it is a constant expression and no floating point math is pulled into the firmware.
+#define ANALOG_MAX_VALUE ((1 << ANALOG_RESOLUTION) - 1)
+
 // The buffer size of any serial input. Defined here for consistent use across the serial handler and avoiding of magic numbers.
 #define SERIAL_INPUT_BUFFER_SIZE 1024
 
+// The sizes of the ring buffers the command responses and the telemetry, like the output mode, are written into before they
+// are sent to the host device, and the sizes of the buffers their lines are collected in, which limit the length of a line.
+#define SERIAL_OUTPUT_BUFFER_SIZE 4096
+#define SERIAL_TELEMETRY_BUFFER_SIZE 2048
+#define SERIAL_OUTPUT_LINE_SIZE 1024
+#define SERIAL_TELEMETRY_LINE_SIZE 64
+
+// The amount of keys that can be pressed in the HID keyboard report at once, besides the modifiers. (6-key rollover)
+#define REPORT_KEYS 6
+
 // The exponent for the amount of samples for the SMA filter. This filter reduces fluctuation of analog values.
-// A value too high may cause unresponsiveness. 1 = 1 sample, 2 = 4 samples, 3 = 8 samples, 4 = 16 samples, ...
+// A value too high may cause unresponsiveness. 0 = 1 sample, 1 = 2 samples, 2 = 4 samples, 3 = 8 samples, 4 = 16 samples, ...
 #define SMA_FILTER_SAMPLE_EXPONENT 4
 
+// The maximum exponent for the amount of samples of the SMA filter that can be configured per key at runtime.
+// The buffers of the filters are sized for this amount of samples. (6 = 64 samples, 128 bytes per key)
+#define SMA_FILTER_MAX_SAMPLE_EXPONENT 6
+
 // The travel distance of the switches, where 1 unit equals 0.01mm. This is used to map the values properly to
 // guarantee that the unit for the numbers used across the firmware actually matches the milimeter metric.
 #define TRAVEL_DISTANCE_IN_0_01MM 400
@@ -59,6 +77,109 @@
 // This millisecond delay is the minimum time between button presses for the HID signal to send to the host device.
 #define DIGITAL_DEBOUNCE_DELAY 0
 
+// The amount of macros that can be stored in the configuration and triggered by keys.
+#define MACROS 4
+
+// The maximum amount of steps (press, release or delay) a single macro can consist of.
+#define MACRO_STEPS 16
+
+// The interval of the timer driving the macro playback, in microseconds. Delay steps of macros are resolved with this
+// granularity. The timer runs independently of the keypad scan, meaning a running macro never slows down scanning.
+#define MACRO_TICK_INTERVAL_US 250
+
+// The GPIO pin of the data line of the addressable RGB LEDs (WS2812). One LED is expected per hall effect key, chained
+// in the order of the keys. The data is shifted out by a PIO state machine, meaning any free GPIO pin can be used.
+#define LED_PIN 22
+
+// The rate at which the LED frames are computed and sent to the LEDs, in frames per second. The frames are computed
+// in a timer interrupt independent of the keypad scan, so a higher rate does not slow down scanning but costs CPU time.
+#define LED_FRAME_RATE 60
+
+// The interval between two keypad scans, in microseconds. The scan runs at this fixed rate with the highest priority,
+// and background tasks like the serial input are only run in the time left until the next scan.
+#define SCAN_INTERVAL_US 125
+
+// The maximum amount of background tasks run by the scheduler in the time between two keypad scans.
+#define SCHEDULER_TASKS 8
+
+// The budget of background tasks that can never fit into the time between two scans, like committing the configuration to
+// the flash memory. These are started whenever it is their turn and delay the next scan by the time they take.
+#define LONG_RUNNING_TASK 0
+
+// The interval between two keypad scans while the keypad is idle, in microseconds. The keypad is considered idle if no key
+// has been touched for the configured idle timeout. Any activity wakes the keypad up within a single idle scan interval.
+#define IDLE_SCAN_INTERVAL_US 1000
+
+// The system clock while the keypad is idle, in kHz. The clock is restored to F_CPU as soon as the keypad wakes up.
+// It has to be achievable by the system PLL, otherwise the clock is not lowered at all.
+#define IDLE_CLOCK_KHZ 48000
+
+// The timeout of the hardware watchdog in milliseconds. If the keypad has not completed a scan for this long, for example
+// because the loop is stuck on a blocking operation, the RP2040 is reset to get the keypad back into a working state. This has
+// to stay well above the longest bounded blocking operation, like committing the configuration to the flash memory, so that
+// those never reset the keypad.
+#define WATCHDOG_TIMEOUT_MS 3000
+
+// The time without a completed scan after which the loop is considered stalled, in milliseconds. The phase running during
+// the stall is kept in the watchdog scratch registers, so it can be retrieved after the watchdog reset the RP2040.
+#define WATCHDOG_STALL_THRESHOLD_MS 20
+
+// The amount of the longest gaps between two completed scans that are remembered, including the phase that was running.
+#define WATCHDOG_STALL_RECORDS 4
+
+// The amount of log2 buckets of the on-device actuation latency histograms. Bucket 0 counts latencies below 1µs, bucket N
+// latencies from 2^(N-1) to 2^N-1µs. The last bucket also counts all latencies beyond it's range. (16 buckets = 16.3ms+)
+#define LATENCY_BUCKETS 16
+
+// Uncomment this line or define it via the build flags to enable the latency probe on the specified GPIO pin. The pin is
+// toggled when the actuation of a key selected via the serial protocol is decided and again when the HID report is handed to
+// TinyUSB, allowing to measure the end-to-end latency externally. If not defined, the probe has no cost at all.
+// #define LATENCY_PROBE_PIN 21
+
+// Uncomment this line or define it via the build flags to verify the invariants of the rapid trigger logic after every check of
+// a hall effect key on the device, counting the violations which can be retrieved via the rtcheck command.
+// #define RAPID_TRIGGER_CHECK
+
+// The amount of iterations each measurement of the benchmark runs, the average of which is reported. The benchmark is
+// only available if the firmware is built with the BENCHMARK definition, e.g. via the minipad-box-bench environment.
+#define BENCHMARK_ITERATIONS 256
+
+// Uncomment this line or define it via the build flags to enable the trace recorder, which records the values of the hall
+// effect keys on every scan into RAM and is controlled via the trace command.
+// #define TRACE_RECORDER
+
+// The amount of scans the trace recorder keeps in RAM, covering the pre- and post-trigger depth together. Every scan takes
+// 4 bytes plus 8 bytes per hall effect key, meaning 2048 scans take 56KB on a 3-key device. Only reserved if the trace
+// recorder is enabled.
+#define TRACE_FRAMES 2048
+
+// The most frames of a trace dump written into the serial output per run of the background task, and the time after which a
+// dump is aborted if the host device does not read any of it, in microseconds.
+#define TRACE_DUMP_FRAMES_PER_RUN 8
+#define TRACE_DUMP_TIMEOUT_US 1000000
+
+// The interval in which the runtime state of the hall effect keys is written into the warm restart snapshot, in milliseconds.
+// After a soft reset (e.g. by the watchdog), the state of at most this long ago is restored instead of calibrating from scratch.
+#define WARM_RESTART_INTERVAL_MS 100
+
+// The maximum length of the name of the keypad, excluding the null terminator.
+#define CONFIG_NAME_LENGTH 32
+
+// The maximum size of the configuration as it is stored in the EEPROM, in bytes. The size of the stored format
+// is checked against this budget at compile time, so the configuration can not silently outgrow the EEPROM.
+#define CONFIG_SIZE_BUDGET 512
+
+// Macro for placing a function of the keypad scan path into SRAM instead of executing it from the flash via the XIP
+// cache. A cache miss costs a flash read over QSPI, which makes the scan time depend on whatever evicted the code
+// from the cache (e.g. the USB stack, serial commands). Define SCAN_PATH_IN_FLASH to keep the functions in flash,
+// which is only meant for comparing the worst-case scan time of both placements with the benchmark.
+// #define SCAN_PATH_IN_FLASH
+#ifdef SCAN_PATH_IN_FLASH
+#define SCAN_FUNC(name) name
+#else
+#define SCAN_FUNC(name) __not_in_flash_func(name)
+#endif
+
 // Macro for getting the hall effect sensor pin of the specified key index. The pin order is being swapped here,
 // meaning on a 3-key device the pins are 28, 27 and 26. This macro has to be adjusted, depending on how the PCB
 // and hardware of the device using this firmware has been designed. The A0 constant is 26 in the RP2040 environment.
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstdint>
+#include "definitions.hpp"
+
+// Measures the cost of the hot-path components of the firmware in CPU cycles. Only compiled into the firmware
+// if the BENCHMARK definition is set, since the measurements are meant for development and not for production.
+#ifdef BENCHMARK
+inline class BenchmarkHandler
+{
+public:
+    void run(Print &output);
+
+private:
+    uint32_t measureScan(bool flush);
+    void report(Print &output, const char *name, uint8_t keys, uint32_t cycles);
+} BenchmarkHandler;
+#endif
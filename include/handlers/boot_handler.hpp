@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// The phases of the boot of the firmware, from entering the setup() function until the keypad is fully usable.
+enum BootPhase : uint8_t
+{
+    // The setup() function was entered.
+    Setup,
+
+    // The USB interfaces were initialized and the host device can start the enumeration.
+    UsbStarted,
+
+    // The configuration was loaded from the EEPROM.
+    ConfigLoaded,
+
+    // The ADC, pins, LEDs and timers were initialized.
+    HardwareReady,
+
+    // The setup() function was left and the first scan is about to start.
+    SetupDone,
+
+    // The first scan completed in which the values of all hall effect keys were valid and checked.
+    ValidScan,
+
+    // The first HID report was sent while the keypad was mounted by the host device.
+    FirstReport,
+
+    // The first key press was decided on, not counting hall effect keys before their calibration is valid.
+    Actuation
+};
+
+// The amount of boot phases above.
+#define BOOT_PHASES 8
+
+// Keeps track of the boot metrics of the firmware, which are the times it took from the reset of the RP2040
+// until the keypad is able to actuate keys and report them to the host device.
+inline class BootHandler
+{
+public:
+    void mark(BootPhase phase);
+    void reported();
+    static const char *getPhaseName(BootPhase phase);
+
+    // The times the boot phases were reached at, in microseconds since firmware bootup. 0 if not reached yet.
+    uint32_t times[BOOT_PHASES] = {};
+} BootHandler;
@@ -8,6 +8,9 @@
 // A struct containing info about the state of a digital key for the keypad handler.
 struct DigitalKeyState : KeyState
 {
-    // The last time a key press on the digital key was sent, in milliseconds since firmware bootup.
-    unsigned long lastDebounce = 0;
+    // The last time a key press on the digital key was sent, in microseconds since firmware bootup.
+    uint32_t lastDebounce = 0;
+
+    // The digital value read from the key pin in the last scan, used to detect pin changes.
+    bool lastReading = false;
 };
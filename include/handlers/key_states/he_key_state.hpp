@@ -17,6 +17,9 @@ struct HEKeyState : KeyState
     // The current peak value for the rapid trigger logic.
     uint16_t rapidTriggerPeak = 65535;
 
+    // The last raw value read from the hall effect sensor, before it was passed through the filter.
+    uint16_t lastRawValue = 0;
+
     // The last value read from the hall effect sensor.
     uint16_t lastSensorValue = 0;
 
@@ -27,7 +30,7 @@ struct HEKeyState : KeyState
     // specifically mapping future values read from the sensors from this range to 0.01mm steps.
     // By default, set the range from analog_resolution²-1 to 0 so it can be updated.
     uint16_t restPosition = 0;
-    uint16_t downPosition = 4095;
+    uint16_t downPosition = ANALOG_MAX_VALUE;
 
     // The simple moving average filter for stabilizing the analog outpt.
     SMAFilter filter = SMAFilter(SMA_FILTER_SAMPLE_EXPONENT);
@@ -9,4 +9,10 @@ struct KeyState
 {
     // State whether the key is currently pressed down.
     bool pressed = false;
+
+    // The HID usage code and modifier bits the key pressed in the HID report, both 0 if the key triggered a macro instead. These
+    // are released instead of the ones in the configuration, so changing the configuration (including the macro assigned to the
+    // key) while the key is pressed down can not leave a key stuck in the report or release the key of another one.
+    uint8_t reportedCode = 0;
+    uint8_t reportedModifiers = 0;
 };
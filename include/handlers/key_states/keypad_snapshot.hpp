@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// A consistent copy of the values of a hall effect key that are of interest outside of the keypad scan.
+struct HEKeySnapshot
+{
+    // State whether the hall effect key is pressed down.
+    bool pressed = false;
+
+    // The raw, filtered and mapped value read from the hall effect sensor.
+    uint16_t rawValue = 0;
+    uint16_t sensorValue = 0;
+    uint16_t mappedValue = 0;
+
+    // The calibrated rest and down position of the hall effect key.
+    uint16_t restPosition = 0;
+    uint16_t downPosition = 0;
+};
+
+// A consistent view of all keys as of the end of a single scan, for readers outside of the keypad scan.
+struct KeypadSnapshot
+{
+    // The amount of scans completed since firmware bootup at the time of the snapshot.
+    uint32_t scan = 0;
+
+    // The snapshots of all hall effect keys.
+    HEKeySnapshot heKeys[HE_KEYS];
+
+    // The pressed states of all digital keys, one bit per key.
+    uint32_t digitalKeys = 0;
+};
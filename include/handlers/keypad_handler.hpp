@@ -4,6 +4,7 @@
 #include "helpers/sma_filter.hpp"
 #include "handlers/key_states/he_key_state.hpp"
 #include "handlers/key_states/digital_key_state.hpp"
+#include "handlers/key_states/keypad_snapshot.hpp"
 #include "definitions.hpp"
 
 inline class KeypadHandler
@@ -23,16 +24,32 @@ public:
     }
 
     void handle();
+    void getSnapshot(KeypadSnapshot &snapshot) const;
     bool outputMode;
+
+    // Bool whether any key was touched during the last scan, used to detect whether the keypad is idle.
+    bool active = false;
     HEKeyState heKeyStates[HE_KEYS];
     DigitalKeyState digitalKeyStates[DIGITAL_KEYS];
 
 private:
+    // Allow the benchmark handler to measure and the native tests to drive the private hot-path functions.
+    friend class BenchmarkHandler;
+    friend class KeypadTest;
+
     void calibrate(const HEKey &key, uint16_t value);
     void checkHEKey(const HEKey &key, uint16_t value);
     void checkDigitalKey(const DigitalKey &key, bool pressed);
     void pressKey(const Key &key);
     void releaseKey(const Key &key);
+    void report();
     uint16_t readKey(const Key &key);
     uint16_t mapSensorValueToTravelDistance(const HEKey &key, uint16_t value) const;
+    void publishSnapshot();
+
+    // The snapshot of the key states, written at the end of every scan and protected by a sequence lock.
+    // The sequence is odd while the snapshot is being written, readers retry until they got an even and unchanged
+    // sequence around their copy. This way, the scan never waits for a reader and readers never see a torn snapshot.
+    KeypadSnapshot snapshot;
+    volatile uint32_t snapshotSequence = 0;
 } KeypadHandler;
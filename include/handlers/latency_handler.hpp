@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include "config/keys/key.hpp"
+#include "definitions.hpp"
+
+// The total amount of keys tracked by the latency handler. Hall effect keys come first, followed by the digital keys.
+#define LATENCY_KEYS (HE_KEYS + DIGITAL_KEYS)
+
+inline class LatencyHandler
+{
+public:
+    void decided(uint8_t key);
+    void reported();
+    void reset();
+
+    // Returns the index of the specified key for the latency handler, where the hall effect keys come first, followed by the digital keys.
+    static uint8_t getKey(const Key &key) { return key.type == KeyType::HallEffect ? key.index : HE_KEYS + key.index; }
+
+    // The log2 histograms of the time from the actuation decision of a key to the submission of the HID report, in microseconds.
+    uint32_t histograms[LATENCY_KEYS][LATENCY_BUCKETS] = {};
+
+private:
+    // A bitmask of the keys that have a decision waiting for the next HID report.
+    uint32_t pending = 0;
+
+    // The time of the oldest decision waiting for the next HID report for every key, in microseconds since firmware bootup.
+    uint32_t decisionTimes[LATENCY_KEYS] = {};
+} LatencyHandler;
+
+// Make sure all keys fit into the bitmask of pending keys.
+static_assert(LATENCY_KEYS <= 32, "The latency handler only supports up to 32 keys.");
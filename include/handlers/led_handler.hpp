@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_states/he_key_state.hpp"
+#include "definitions.hpp"
+extern "C"
+{
+#include "pico/time.h"
+#include "hardware/pio.h"
+}
+
+inline class LEDHandler
+{
+public:
+    void begin();
+    void publish(const HEKeyState *states);
+    void updateClock();
+
+    // The amount of CPU cycles the last and the most expensive call of the publish function took.
+    // Used to monitor the cost the LEDs add to the keypad scan, which should stay small and bounded.
+    uint32_t lastPublishCycles = 0;
+    uint32_t maxPublishCycles = 0;
+
+    // The amount of frames computed and sent to the LEDs and the amount of frames skipped
+    // because the previous frame was still being shifted out by the DMA.
+    uint32_t frames = 0;
+    uint32_t skippedFrames = 0;
+
+private:
+    static bool tick(repeating_timer_t *timer);
+    void render();
+
+    // The repeating timer computing the frames at the LED_FRAME_RATE.
+    repeating_timer_t timer;
+
+    // The PIO block, state machine and DMA channel used to shift out the frames.
+    PIO pio = pio0;
+    uint sm = 0;
+    int dmaChannel = -1;
+
+    // The key states published by the keypad handler, packed as (pressed << 16 | travel distance).
+    // A single aligned 32-bit store is atomic, meaning the timer never reads a half-written key state.
+    volatile uint32_t keyStates[HE_KEYS] = {};
+
+    // The frame buffer read by the DMA, containing the colors of the LEDs in the GRB format expected by the WS2812.
+    uint32_t frame[HE_KEYS] = {};
+} LEDHandler;
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include "config/configuration_controller.hpp"
+#include "definitions.hpp"
+extern "C"
+{
+#include "pico/time.h"
+}
+
+// The size of the queue holding the key events produced by the macro timer until the keypad handler applies them.
+#define MACRO_EVENT_QUEUE_SIZE 32
+
+inline class MacroHandler
+{
+public:
+    void begin();
+    void trigger(uint8_t index);
+    bool apply();
+
+    // Returns whether the macro with the specified index is currently being played back.
+    bool isRunning(uint8_t index) const { return players[index].running; }
+
+private:
+    // The playback state of a single macro, only modified inside the timer interrupt once the playback was requested.
+    struct MacroPlayer
+    {
+        // Bool whether the macro is currently being played back.
+        volatile bool running = false;
+
+        // The copy of the macro that is played back, taken when the playback is requested. The timer never reads the
+        // configuration itself, since it may be rewritten at any time by the serial interface.
+        Macro macro;
+
+        // The index of the next step to be executed.
+        uint8_t step = 0;
+
+        // The time in microseconds since bootup at which the next step is due.
+        uint32_t dueAt = 0;
+
+        // The key chars (as a 256 bit set) currently held by the macro, released once the playback is finished.
+        uint32_t held[8] = {};
+    };
+
+    // A key event produced by the macro timer, consumed by the keypad handler before sending the HID report.
+    struct MacroEvent
+    {
+        // Bool whether the key is pressed or released.
+        bool press;
+
+        // The HID usage code and modifier bits of the key char that is pressed or released.
+        uint8_t code;
+        uint8_t modifiers;
+    };
+
+    static bool tick(repeating_timer_t *timer);
+    void advance(uint8_t index, uint32_t now);
+    bool push(bool press, char keyChar);
+
+    // The repeating timer driving the macro playback.
+    repeating_timer_t timer;
+
+    // The playback states of all macros.
+    MacroPlayer players[MACROS];
+
+    // The start requests for the macros, set by the keypad handler and picked up by the timer.
+    volatile bool pendingStarts[MACROS] = {};
+
+    // The single-producer (timer), single-consumer (keypad handler) ring buffer of key events.
+    MacroEvent events[MACRO_EVENT_QUEUE_SIZE];
+    volatile uint8_t eventHead = 0;
+    volatile uint8_t eventTail = 0;
+
+    // The usage codes (as a 256 bit set) and modifier bits pressed by macros since the last submitted HID report, and the
+    // amount of submitted reports at the time these started being collected. Releases of them are held back until the
+    // report with the press was submitted, since the host device would never see the key otherwise.
+    uint32_t batchCodes[8] = {};
+    uint8_t batchModifiers = 0;
+    uint32_t batchReport = 0;
+} MacroHandler;
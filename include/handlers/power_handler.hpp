@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include "config/configuration_controller.hpp"
+#include "definitions.hpp"
+
+inline class PowerHandler
+{
+public:
+    void update(bool active, uint32_t scanStart);
+
+    // Bool whether the keypad is currently idle, scanning at a reduced rate and clock.
+    bool idle = false;
+
+    // The amount of times the keypad went idle and woke up again.
+    uint32_t entries = 0;
+    uint32_t exits = 0;
+
+    // The time it took to get back to the full scan rate and clock after activity was detected, in microseconds.
+    // Measured from the start of the scan that detected the activity until the clock has been restored.
+    uint32_t lastWakeLatency = 0;
+    uint32_t maxWakeLatency = 0;
+
+private:
+    void enterIdle();
+    void exitIdle(uint32_t scanStart);
+
+    // The time of the last scan with key activity, in milliseconds since firmware bootup.
+    unsigned long lastActivity = 0;
+} PowerHandler;
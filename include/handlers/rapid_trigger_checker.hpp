@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include "config/keys/he_key.hpp"
+#include "handlers/key_states/he_key_state.hpp"
+#include "definitions.hpp"
+
+// An enum used to identify the invariant of the rapid trigger logic that was violated.
+enum RapidTriggerViolation : uint8_t
+{
+    // The key was pressed without entering the rapid trigger zone or travelling down by the down sensitivity from the peak.
+    UnexpectedPress,
+
+    // The key was released without leaving the rapid trigger zone or travelling up by the up sensitivity from the peak.
+    UnexpectedRelease,
+
+    // The key is still pressed even though it is above the point at which it always has to be released.
+    StuckKey
+};
+
+// The amount of different rapid trigger violations.
+#define RAPID_TRIGGER_VIOLATIONS 3
+
+// Checks the invariants of the rapid trigger logic after every check of a hall effect key, counting the violations.
+// This runs on the real key trajectories and can be used as an oracle to verify any reimplementation of the logic.
+// Only compiled into the firmware if the RAPID_TRIGGER_CHECK definition is set, since it costs time on every scan.
+#ifdef RAPID_TRIGGER_CHECK
+inline class RapidTriggerChecker
+{
+public:
+    void check(const HEKey &key, bool wasPressed, uint16_t previousPeak, const HEKeyState &state, uint16_t value);
+    void reset();
+
+    // The amount of violations of every invariant for every hall effect key.
+    uint32_t violations[HE_KEYS][RAPID_TRIGGER_VIOLATIONS] = {};
+} RapidTriggerChecker;
+#endif
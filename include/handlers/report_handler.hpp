@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// Builds the HID keyboard report from the usage codes and modifier bits precompiled in the configuration of the keys and
+// submits it to TinyUSB directly, instead of converting key chars and searching the report on every press in the keyboard library.
+// Keys sharing a usage code or modifier are counted, so releasing one of them does not release it for the others.
+inline class ReportHandler
+{
+public:
+    bool press(uint8_t code, uint8_t modifiers);
+    void release(uint8_t code, uint8_t modifiers);
+    bool send();
+
+    // Returns whether the report changed since it was last submitted.
+    bool isChanged() const { return dirty; }
+
+    // The amount of reports submitted to the host device and presses dropped because all key slots of the report were in use.
+    uint32_t reports = 0;
+    uint32_t overflows = 0;
+
+private:
+    // The modifier byte and key slots of the report.
+    uint8_t modifiers = 0;
+    uint8_t keys[REPORT_KEYS] = {};
+
+    // The amount of pressed keys holding each key slot and modifier bit.
+    uint8_t keyCounts[REPORT_KEYS] = {};
+    uint8_t modifierCounts[8] = {};
+
+    // Whether the report changed since it was last submitted. Set initially, so the report is submitted once the host device is ready.
+    bool dirty = true;
+} ReportHandler;
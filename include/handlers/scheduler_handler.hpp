@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// A background task run by the scheduler in the slack time between two keypad scans.
+struct Task
+{
+    // The name of the task for the serial output.
+    const char *name;
+
+    // The function run on every invocation of the task.
+    void (*function)();
+
+    // The time an invocation of the task is expected to take at most, in microseconds. The task is only started if at least this
+    // much time is left until the next scan. Invocations taking longer than this are counted as overruns. Long-running tasks
+    // have no budget, they are started whenever it is their turn and delay the next scan by the time they take.
+    uint32_t budget;
+
+    // The amount of invocations, overruns and times the task was skipped because there was not enough slack time left.
+    uint32_t runs;
+    uint32_t overruns;
+    uint32_t deferrals;
+
+    // The longest invocation of the task, in microseconds.
+    uint32_t maxDuration;
+};
+
+// A cooperative scheduler running the keypad scan at a fixed rate as the task with the highest priority, and the
+// background tasks in round-robin order in the slack time left until the next scan. Tasks can not be interrupted,
+// which is why each of them has a time budget that is checked before it is started and accounted after it ran.
+inline class SchedulerHandler
+{
+public:
+    void begin(void (*scan)());
+    void addTask(const char *name, void (*function)(), uint32_t budget);
+    void run();
+
+    // The background tasks and the amount of them.
+    Task tasks[SCHEDULER_TASKS];
+    uint8_t taskCount = 0;
+
+    // The amount of scans, the amount of scans that started more than a whole scan interval late and the longest scan in microseconds.
+    uint32_t scans = 0;
+    uint32_t lateScans = 0;
+    uint32_t maxScanDuration = 0;
+
+private:
+    void runTasks();
+    void wait();
+
+    // The function running the keypad scan.
+    void (*scan)() = nullptr;
+
+    // The time the next scan is due at, in microseconds since firmware bootup.
+    uint32_t nextScan = 0;
+
+    // The index of the background task that is started first in the next slack time.
+    uint8_t nextTask = 0;
+} SchedulerHandler;
@@ -1,26 +1,72 @@
 #pragma once
 
+#include <Arduino.h>
 #include "config/configuration_controller.hpp"
+#include "handlers/key_states/keypad_snapshot.hpp"
+#include "handlers/serial_output_handler.hpp"
+#include "definitions.hpp"
 
 inline class SerialHandler
 {
 public:
-    void handleSerialInput(char *input);
-    void printHEKeyOutput(const HEKey &key);
+    void update();
+    void handleSerialInput(char *input, Print &output = SerialOutputHandler);
+    void printHEKeyOutput(const KeypadSnapshot &snapshot);
+    void stream();
 
 private:
+    bool isConfigCommand(const char *command);
+    void handleCommand(const char *command, char *input);
     void boot();
     void save();
     void get();
+    void exportConfig();
+    void importConfig(const char *hex);
     void name(char *name);
     void out(bool single, bool state);
+    void led(bool single, uint8_t brightness);
+    void idle(bool single, uint16_t timeout);
+    void watchdog();
+    void tasks();
+    void serialout();
+    void boottime();
+    void latency(bool reset);
+#ifdef TRACE_RECORDER
+    void trace(char *parameters);
+#endif
     void echo(char *input);
+#ifdef RAPID_TRIGGER_CHECK
+    void rtcheck(bool reset);
+#endif
     void hkey_rt(HEKey &key, bool state);
     void hkey_crt(HEKey &key, bool state);
     void hkey_rtus(HEKey &key, uint16_t value);
     void hkey_rtds(HEKey &key, uint16_t value);
     void hkey_lh(HEKey &key, uint16_t value);
     void hkey_uh(HEKey &key, uint16_t value);
+    void hkey_color(HEKey &key, uint32_t color);
+    void hkey_smaexp(HEKey &key, uint8_t exponent);
     void key_char(Key &key, uint8_t keyChar);
+    void key_code(Key &key, uint32_t code);
+    void key_mod(Key &key, uint32_t modifiers);
     void key_hid(Key &key, bool state);
+    void key_macro(Key &key, uint8_t macro);
+#ifdef LATENCY_PROBE_PIN
+    void key_probe(Key &key, bool state);
+#endif
+    void macro_steps(Macro &macro, char *steps);
+    void formatMacroSteps(const Macro &macro, char *buffer);
+
+    // The interface the response of the current command is written to and the one the output mode is streamed to.
+    // Commands can be received via any interface (e.g. the serial interface or a test harness), sharing the same command logic.
+    Print *output = &SerialOutputHandler;
+    Print *streamOutput = &SerialOutputHandler;
+
+    // The line currently being received via the serial interface, it's length and whether it did not fit into the buffer.
+    char input[SERIAL_INPUT_BUFFER_SIZE];
+    uint16_t inputLength = 0;
+    bool inputOverflow = false;
+
+    // The number of the last scan whose values were output in output mode.
+    uint32_t lastStreamedScan = 0;
 } SerialHandler;
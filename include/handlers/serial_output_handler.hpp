@@ -0,0 +1,93 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstdint>
+#include "definitions.hpp"
+
+// The channels of the serial output, each of which is buffered independently so neither of them can starve the other one.
+enum OutputChannel : uint8_t
+{
+    // Data streamed continuously without being requested, like the values of the output mode. Only sent while no command
+    // response is waiting and dropped if it's buffer is full, without ever waiting for the host device.
+    Telemetry,
+
+    // Responses to commands sent by the host device. Sent before any telemetry and only dropped if the host device does not
+    // read them fast enough for them to fit into their larger buffer.
+    Response
+};
+
+// A ring buffer of one channel of the serial output.
+struct OutputQueue
+{
+    // The buffer and it's size in bytes.
+    uint8_t *buffer;
+    uint16_t size;
+
+    // The buffer the current line is collected in before it is written into the ring buffer as a whole, and it's size in bytes.
+    uint8_t *line;
+    uint16_t lineSize;
+
+    // The index of the next byte that is written into the buffer and the index of the next byte that is sent.
+    uint16_t head;
+    uint16_t tail;
+
+    // The amount of bytes currently waiting in the buffer and the most bytes that were waiting in it at once.
+    uint16_t queued;
+    uint16_t maxQueued;
+
+    // The amount of bytes sent to the host device and the amount of bytes dropped because the buffer was full.
+    uint32_t sent;
+    uint32_t dropped;
+
+    // The length of the line currently being collected and whether it is longer than the line buffer, in which case it is dropped.
+    uint16_t lineLength;
+    bool lineOverflow;
+
+    // Whether a binary block is currently being written, which bypasses the line buffer, and whether bytes of it are still
+    // waiting to be sent, in which case the other channel is not sent so it can not end up in the middle of the block.
+    bool block;
+    bool blockPending;
+
+    // Whether a line was sent partially, in which case the other channel is not sent until the line is finished.
+    bool lineStarted;
+};
+
+// Buffers all data written to the serial interface in bounded ring buffers, one per channel, which are drained into the USB CDC
+// interface in the background as far as the host device reads it. Text is collected line by line and only written into the
+// ring buffers as whole lines, meaning lines are either sent or dropped as a whole. Binary blocks, like trace dumps, bypass
+// this and are written as they are. Command responses are sent first and the channels are only switched at the end of a line
+// and outside of binary blocks, meaning the two never interleave. Writing never waits for the host device, data that does not
+// fit into it's buffer is dropped and counted instead, guaranteeing that the keypad scan is never blocked by a host device that
+// does not read the serial interface. Both channels are sent
+// over the same serial interface, there is no second interface the telemetry or the dumps could be moved to.
+inline class SerialOutputHandler : public Print
+{
+public:
+    void update();
+    void setChannel(OutputChannel channel);
+    void beginBlock();
+    void endBlock();
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *data, size_t size) override;
+    using Print::write;
+    int availableForWrite() override;
+    void flush() override;
+
+    // The queues of all channels, indexed by the channel.
+    OutputQueue queues[2] = {{telemetryBuffer, SERIAL_TELEMETRY_BUFFER_SIZE, telemetryLine, SERIAL_TELEMETRY_LINE_SIZE, 0, 0, 0, 0, 0, 0, 0, false, false, false, false},
+                             {responseBuffer, SERIAL_OUTPUT_BUFFER_SIZE, responseLine, SERIAL_OUTPUT_LINE_SIZE, 0, 0, 0, 0, 0, 0, 0, false, false, false, false}};
+
+private:
+    void commit(OutputQueue &queue, const uint8_t *data, size_t size);
+    bool reserve(OutputQueue &queue, size_t size);
+    size_t drain();
+
+    // The buffers of the telemetry and the command responses and the buffers their current lines are collected in.
+    uint8_t telemetryBuffer[SERIAL_TELEMETRY_BUFFER_SIZE];
+    uint8_t responseBuffer[SERIAL_OUTPUT_BUFFER_SIZE];
+    uint8_t telemetryLine[SERIAL_TELEMETRY_LINE_SIZE];
+    uint8_t responseLine[SERIAL_OUTPUT_LINE_SIZE];
+
+    // The channel of the data that is currently being written.
+    OutputChannel channel = OutputChannel::Response;
+} SerialOutputHandler;
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include "handlers/key_states/he_key_state.hpp"
+#include "definitions.hpp"
+
+// An enum used to identify what starts the post-trigger recording of the trace recorder.
+enum TraceTrigger : uint8_t
+{
+    // The trigger is fired manually via the serial protocol.
+    Manual,
+
+    // The trigger fires when any hall effect key is pressed.
+    OnPress,
+
+    // The trigger fires when the mapped value of any hall effect key drops to or below the trigger value.
+    OnValue
+};
+
+// An enum used to identify the state of the trace recorder.
+enum TraceState : uint8_t
+{
+    // Not recording, nothing has been recorded since bootup or the trace was cleared.
+    Stopped,
+
+    // Recording the pre-trigger scans while waiting for the trigger to fire.
+    Armed,
+
+    // Recording the post-trigger scans after the trigger fired.
+    Triggered,
+
+    // The recording is finished and the trace can be dumped.
+    Finished
+};
+
+// The values of a single hall effect key in a single scan. The layout is part of the dump format and must not be changed.
+struct __attribute__((packed)) TraceSample
+{
+    uint16_t raw;
+    uint16_t filtered;
+    uint16_t mapped;
+
+    // Bit 0: pressed, bit 1: in rapid trigger zone, bit 2: pressed in this scan, bit 3: released in this scan.
+    uint8_t flags;
+    uint8_t reserved;
+};
+
+// The values of all hall effect keys in a single scan. The layout is part of the dump format and must not be changed.
+struct __attribute__((packed)) TraceFrame
+{
+    // The time of the scan in microseconds since firmware bootup.
+    uint32_t time;
+
+    // The samples of all hall effect keys.
+    TraceSample samples[HE_KEYS];
+};
+
+// Records the values of the hall effect keys on every scan into RAM. Only compiled into the firmware if the TRACE_RECORDER
+// definition is set, since the frames take up a large part of the RAM.
+#ifdef TRACE_RECORDER
+inline class TraceHandler
+{
+public:
+    void arm(TraceTrigger trigger, uint16_t preFrames, uint16_t postFrames, uint16_t value);
+    void fire();
+    void record(const HEKeyState *states);
+    bool dump();
+    void update();
+    bool isDumping();
+
+    // The current state of the trace recorder.
+    volatile TraceState state = TraceState::Stopped;
+
+private:
+    // The trigger, it's value and the pre- and post-trigger depth of the current recording.
+    TraceTrigger trigger = TraceTrigger::Manual;
+    uint16_t triggerValue = 0;
+    uint16_t preFrames = 0;
+    uint16_t postFrames = 0;
+
+    // The ring buffer of recorded frames, the index of the next frame to be written and the amount of frames recorded.
+    TraceFrame frames[TRACE_FRAMES];
+    uint16_t head = 0;
+    uint16_t recorded = 0;
+
+    // The index of the frame the trigger fired on and the amount of post-trigger frames still to be recorded.
+    uint16_t triggerFrame = 0;
+    uint16_t remaining = 0;
+
+    // Bool whether the manual trigger has been fired and the pressed states of the keys in the previous scan. The pressed
+    // states are only valid after the first scan of a recording, since no scans are recorded while the recorder is stopped.
+    volatile bool manualFired = false;
+    bool wasPressed[HE_KEYS] = {};
+    bool wasPressedValid = false;
+
+    // Bool whether the recording is currently being dumped, the index of the next part of the dump (0 being the header, followed by
+    // the frames and the checksum), the index of the oldest frame, the checksum of the parts written so far and the time of the
+    // last part written.
+    bool dumping = false;
+    uint16_t dumpIndex = 0;
+    uint16_t dumpFirst = 0;
+    uint32_t dumpCrc = 0;
+    uint32_t dumpProgress = 0;
+} TraceHandler;
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// The runtime state of a hall effect key that is kept across soft resets.
+struct WarmKeyState
+{
+    // The calibrated rest and down position of the key.
+    uint16_t restPosition;
+    uint16_t downPosition;
+
+    // The last output of the SMA filter of the key, used to seed the filter after the restart.
+    uint16_t filteredValue;
+};
+
+// The snapshot of the runtime state of all hall effect keys, stored in RAM that is not initialized on bootup.
+struct WarmRestartSnapshot
+{
+    // The magic number identifying a written snapshot.
+    uint32_t magic;
+
+    // The amount of hall effect keys and the ADC resolution of the firmware that wrote the snapshot.
+    uint8_t keys;
+    uint8_t analogResolution;
+
+    // The state of the hall effect keys.
+    WarmKeyState heKeys[HE_KEYS];
+
+    // The CRC32 checksum of all fields above.
+    uint32_t crc;
+};
+
+// Keeps the runtime state of the hall effect keys (calibration and filters) across soft resets like watchdog resets
+// or leaving the bootloader, by writing it into RAM that survives these resets and restoring it on bootup.
+inline class WarmRestartHandler
+{
+public:
+    void restore();
+    void update();
+    void save();
+
+    // Bool whether the state of the keys was restored from the snapshot on bootup.
+    bool restored = false;
+
+private:
+    uint32_t checksum() const;
+
+    // The time the snapshot was last written at, in microseconds since firmware bootup.
+    uint32_t lastSave = 0;
+} WarmRestartHandler;
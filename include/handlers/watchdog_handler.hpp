@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+extern "C"
+{
+#include "pico/time.h"
+}
+
+// An enum used to identify the phase of the main loop the firmware is currently in.
+enum LoopPhase : uint8_t
+{
+    // Scanning the keys and updating the HID report.
+    Scanning,
+
+    // Sending the HID report via USB.
+    Reporting,
+
+    // Sleeping between two scans while the keypad is idle.
+    Sleeping,
+
+    // Reading and handling serial input.
+    SerialInput,
+
+    // Writing the configuration to the EEPROM.
+    ConfigSave,
+
+    // Anything outside of the other phases, like the Arduino runtime between two iterations of the loop.
+    Other
+};
+
+// A gap between two completed scans, including the phase that took the longest during that gap.
+struct StallRecord
+{
+    // The length of the gap in microseconds.
+    uint32_t gap = 0;
+
+    // The phase that took the longest during the gap.
+    LoopPhase phase = LoopPhase::Other;
+
+    // The time the gap ended at, in milliseconds since firmware bootup.
+    uint32_t uptime = 0;
+};
+
+inline class WatchdogHandler
+{
+public:
+    void begin();
+    LoopPhase enter(LoopPhase phase);
+    void scanCompleted();
+    static const char *getPhaseName(LoopPhase phase);
+
+    // The longest gaps between two completed scans, sorted from the longest to the shortest.
+    StallRecord records[WATCHDOG_STALL_RECORDS];
+
+    // The stall that was ongoing when the RP2040 was reset, read from the watchdog scratch registers on bootup.
+    // The gap is only known with the resolution of the stall check timer and is stored in milliseconds here.
+    bool hasPostMortem = false;
+    StallRecord postMortem;
+
+    // Bool whether the last reset was caused by the watchdog.
+    bool causedReboot = false;
+
+private:
+    static bool check(repeating_timer_t *timer);
+
+    // The repeating timer checking for an ongoing stall and writing it into the scratch registers.
+    repeating_timer_t timer;
+
+    // The phase the loop is currently in and the time it was entered at, in microseconds since firmware bootup.
+    volatile LoopPhase phase = LoopPhase::Other;
+    uint32_t phaseStart = 0;
+
+    // The phase that took the longest since the last completed scan and it's duration in microseconds.
+    LoopPhase culprit = LoopPhase::Other;
+    uint32_t culpritDuration = 0;
+
+    // The time the last scan was completed at, in microseconds since firmware bootup.
+    volatile uint32_t lastScan = 0;
+
+    // Bool whether an ongoing stall has been written into the scratch registers.
+    volatile bool stallWritten = false;
+} WatchdogHandler;
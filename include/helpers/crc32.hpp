@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace CRC32
+{
+    uint32_t update(uint32_t crc, const void *data, size_t length);
+    uint32_t compute(const void *data, size_t length);
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+
+// The bit of the left shift key in the modifier byte of the HID keyboard report.
+#define HID_MODIFIER_LEFT_SHIFT 0x02
+
+namespace HIDHelper
+{
+    void getUsage(uint8_t keyChar, uint8_t *code, uint8_t *modifiers);
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+#ifdef LATENCY_PROBE_PIN
+extern "C"
+{
+#include "hardware/gpio.h"
+}
+#endif
+
+// The latency probe toggles the LATENCY_PROBE_PIN when an actuation of a selected key is decided and again when the HID
+// report containing it has been handed to TinyUSB, allowing to measure the end-to-end latency with a logic analyzer.
+// If the LATENCY_PROBE_PIN is not defined via the build flags, all functions are empty and optimized away.
+namespace LatencyProbe
+{
+#ifdef LATENCY_PROBE_PIN
+    // A bitmask of the keys (in the order of the latency handler) that toggle the probe pin when actuated.
+    inline uint32_t keys = 0;
+
+    // Bool whether the probe pin has been toggled for a decision and is waiting for the HID report.
+    inline bool armed = false;
+
+    // Initializes the probe pin as a low output.
+    inline void begin()
+    {
+        gpio_init(LATENCY_PROBE_PIN);
+        gpio_set_dir(LATENCY_PROBE_PIN, true);
+        gpio_put(LATENCY_PROBE_PIN, false);
+    }
+
+    // Toggles the probe pin if the key is selected and the probe is not already waiting for the HID report.
+    // Only the first decision of a report toggles the pin, so every edge on a decision is followed by one on the report.
+    inline void decided(uint8_t key)
+    {
+        if (armed || !(keys & (1UL << key)))
+            return;
+
+        gpio_xor_mask(1UL << LATENCY_PROBE_PIN);
+        armed = true;
+    }
+
+    // Toggles the probe pin again if a decision is waiting for the HID report.
+    inline void reported()
+    {
+        if (!armed)
+            return;
+
+        gpio_xor_mask(1UL << LATENCY_PROBE_PIN);
+        armed = false;
+    }
+#else
+    inline void begin() {}
+    inline void decided(uint8_t) {}
+    inline void reported() {}
+#endif
+};
@@ -1,6 +1,11 @@
 #pragma once
 
 #include <cstdint>
+#include "definitions.hpp"
+
+// The sample exponent is limited to 7 so the amount of samples and the index of the buffer fit into 8 bits.
+static_assert(SMA_FILTER_MAX_SAMPLE_EXPONENT <= 7, "SMA_FILTER_MAX_SAMPLE_EXPONENT can not be higher than 7.");
+static_assert(SMA_FILTER_SAMPLE_EXPONENT <= SMA_FILTER_MAX_SAMPLE_EXPONENT, "SMA_FILTER_SAMPLE_EXPONENT can not be higher than SMA_FILTER_MAX_SAMPLE_EXPONENT.");
 
 class SMAFilter
 {
@@ -8,26 +13,32 @@ public:
     SMAFilter() {}
 
     // Initialize the SMAFilter instance with the specified sample exponent.
-    // (1 = 1 sample, 2 = 4 samples, 3 = 8 samples, ...)
+    // (0 = 1 sample, 1 = 2 samples, 2 = 4 samples, ...)
     SMAFilter(uint8_t samplesExponent)
         : samplesExponent(samplesExponent)
         , samples(1 << samplesExponent)
-        , buffer(new uint16_t[samples] {0})
     {}
 
     // The call operator for passing values through the filter.
     uint16_t operator()(uint16_t value);
 
-    // Bool whether the whole buffer has been written at least once.
+    // Changes the sample exponent of the filter and returns the current one.
+    void setSamplesExponent(uint8_t exponent);
+    uint8_t getSamplesExponent() const { return samplesExponent; }
+
+    // Bool whether the filter has been seeded with the first value and outputs valid values.
     bool initialized = false;
 
 private:
+    void seed(uint16_t value);
+
     // The amount of samples and the exponent.
-    uint8_t samplesExponent;
-    uint8_t samples;
+    uint8_t samplesExponent = 0;
+    uint8_t samples = 1;
 
-    // The buffer containing all values.
-    uint16_t *buffer;
+    // The buffer containing all values. It is sized for the maximum amount of samples so the
+    // amount can be changed at runtime without allocating memory.
+    uint16_t buffer[1 << SMA_FILTER_MAX_SAMPLE_EXPONENT] = {0};
 
     // The index of the oldest and thus next element to overwrite.
     uint8_t index = 0;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 
 namespace StringHelper
 {
@@ -8,4 +9,8 @@ namespace StringHelper
     void toLower(char *input);
     void replace(char *input, char target, char replacement);
     void makeSafename(char *str);
+    bool parseIndex(const char *input, uint8_t count, uint8_t *index);
+    bool parseNumber(const char *input, uint32_t max, uint32_t *value);
+    void toHex(const void *data, size_t length, char *output);
+    bool fromHex(const char *input, void *data, size_t length);
 };
@@ -1,14 +1,18 @@
 #include <EEPROM.h>
 #include <Arduino.h>
 #include "config/configuration_controller.hpp"
+#include "handlers/watchdog_handler.hpp"
+#include "helpers/crc32.hpp"
 
 void ConfigurationController::loadConfig()
 {
-    // Load the configuration struct from the EEPROM.
-    EEPROM.get(0, config);
+    // Load the persistent configuration from the EEPROM and convert it into the runtime configuration.
+    static PersistentConfiguration persistent;
+    EEPROM.get(0, persistent);
+    unpack(persistent, config);
 
-    // Check if the version matches with the one read; If not, replace the config with it's default state.
-    if (config.version != defaultConfig.version)
+    // Check if the version matches with the one read and the config is valid; If not, replace the config with it's default state.
+    if (config.version != defaultConfig.version || !isValid(config))
     {
         config = defaultConfig;
         saveConfig();
@@ -17,7 +21,210 @@ void ConfigurationController::loadConfig()
 
 void ConfigurationController::saveConfig()
 {
-    // Write the struct back into the EEPROM and commit the change.
-    EEPROM.put(0, config);
+    // Convert the runtime configuration into the persistent format, write it into the EEPROM and commit the change.
+    static PersistentConfiguration persistent;
+    pack(config, persistent);
+    LoopPhase previous = WatchdogHandler.enter(LoopPhase::ConfigSave);
+    EEPROM.put(0, persistent);
     EEPROM.commit();
+    WatchdogHandler.enter(previous);
+}
+
+void ConfigurationController::requestSave()
+{
+    // Remember that the configuration has to be saved. Writing the EEPROM takes a long time, which is why
+    // it is done by a background task of the scheduler instead of in the middle of a command.
+    savePending = true;
+}
+
+void ConfigurationController::update()
+{
+    // Save the configuration if it was requested.
+    if (savePending)
+    {
+        savePending = false;
+        saveConfig();
+    }
+}
+
+void ConfigurationController::pack(const Configuration &config, PersistentConfiguration &persistent) const
+{
+    // Copy the global settings. The name is padded with zeroes and not terminated if it uses the whole field.
+    persistent.version = config.version;
+    memset(persistent.name, 0, CONFIG_NAME_LENGTH);
+    memcpy(persistent.name, config.name, strnlen(config.name, CONFIG_NAME_LENGTH));
+    persistent.ledBrightness = config.ledBrightness;
+    persistent.idleTimeout = config.idleTimeout;
+
+    // Copy the settings of the hall effect keys, merging the bools into the flags. The type and index are not stored,
+    // since they are given by the position of the key in the array.
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        const HEKey &key = config.heKeys[i];
+        PersistentHEKey &output = persistent.heKeys[i];
+        output.flags = (key.hidEnabled ? PERSISTENT_KEY_HID_ENABLED : 0) |
+                       (key.rapidTrigger ? PERSISTENT_KEY_RAPID_TRIGGER : 0) |
+                       (key.continuousRapidTrigger ? PERSISTENT_KEY_CONTINUOUS_RAPID_TRIGGER : 0);
+        output.keyChar = key.keyChar;
+        output.keyCode = key.keyCode;
+        output.keyModifiers = key.keyModifiers;
+        output.macro = key.macro;
+        output.smaExponent = key.smaExponent;
+        output.rapidTriggerUpSensitivity = key.rapidTriggerUpSensitivity;
+        output.rapidTriggerDownSensitivity = key.rapidTriggerDownSensitivity;
+        output.lowerHysteresis = key.lowerHysteresis;
+        output.upperHysteresis = key.upperHysteresis;
+        output.color[0] = key.color >> 16;
+        output.color[1] = key.color >> 8;
+        output.color[2] = key.color;
+    }
+
+    // Copy the settings of the digital keys.
+    for (uint8_t i = 0; i < DIGITAL_KEYS; i++)
+    {
+        const DigitalKey &key = config.digitalKeys[i];
+        PersistentDigitalKey &output = persistent.digitalKeys[i];
+        output.flags = key.hidEnabled ? PERSISTENT_KEY_HID_ENABLED : 0;
+        output.keyChar = key.keyChar;
+        output.keyCode = key.keyCode;
+        output.keyModifiers = key.keyModifiers;
+        output.macro = key.macro;
+    }
+
+    // Copy the macros. Unused steps are copied as well, so the stored data only depends on the configuration.
+    for (uint8_t i = 0; i < MACROS; i++)
+    {
+        persistent.macros[i].length = config.macros[i].length;
+        for (uint8_t j = 0; j < MACRO_STEPS; j++)
+        {
+            persistent.macros[i].steps[j].type = config.macros[i].steps[j].type;
+            persistent.macros[i].steps[j].value = config.macros[i].steps[j].value;
+        }
+    }
+}
+
+void ConfigurationController::unpack(const PersistentConfiguration &persistent, Configuration &config) const
+{
+    // Start with the default configuration, which contains the type and index of every key.
+    config = defaultConfig;
+
+    // Copy the global settings, terminating the name in case it uses the whole buffer.
+    config.version = persistent.version;
+    memcpy(config.name, persistent.name, CONFIG_NAME_LENGTH);
+    config.name[CONFIG_NAME_LENGTH] = '\0';
+    config.ledBrightness = persistent.ledBrightness;
+    config.idleTimeout = persistent.idleTimeout;
+
+    // Copy the settings of the hall effect keys, splitting the flags into the bools.
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        const PersistentHEKey &input = persistent.heKeys[i];
+        HEKey &key = config.heKeys[i];
+        key.hidEnabled = input.flags & PERSISTENT_KEY_HID_ENABLED;
+        key.rapidTrigger = input.flags & PERSISTENT_KEY_RAPID_TRIGGER;
+        key.continuousRapidTrigger = input.flags & PERSISTENT_KEY_CONTINUOUS_RAPID_TRIGGER;
+        key.keyChar = input.keyChar;
+        key.keyCode = input.keyCode;
+        key.keyModifiers = input.keyModifiers;
+        key.macro = input.macro;
+        key.smaExponent = input.smaExponent;
+        key.rapidTriggerUpSensitivity = input.rapidTriggerUpSensitivity;
+        key.rapidTriggerDownSensitivity = input.rapidTriggerDownSensitivity;
+        key.lowerHysteresis = input.lowerHysteresis;
+        key.upperHysteresis = input.upperHysteresis;
+        key.color = (uint32_t)input.color[0] << 16 | (uint32_t)input.color[1] << 8 | input.color[2];
+    }
+
+    // Copy the settings of the digital keys.
+    for (uint8_t i = 0; i < DIGITAL_KEYS; i++)
+    {
+        const PersistentDigitalKey &input = persistent.digitalKeys[i];
+        DigitalKey &key = config.digitalKeys[i];
+        key.hidEnabled = input.flags & PERSISTENT_KEY_HID_ENABLED;
+        key.keyChar = input.keyChar;
+        key.keyCode = input.keyCode;
+        key.keyModifiers = input.keyModifiers;
+        key.macro = input.macro;
+    }
+
+    // Copy the macros.
+    for (uint8_t i = 0; i < MACROS; i++)
+    {
+        config.macros[i].length = persistent.macros[i].length;
+        for (uint8_t j = 0; j < MACRO_STEPS; j++)
+        {
+            config.macros[i].steps[j].type = (MacroStepType)persistent.macros[i].steps[j].type;
+            config.macros[i].steps[j].value = persistent.macros[i].steps[j].value;
+        }
+    }
+}
+
+bool ConfigurationController::isValid(const Configuration &config) const
+{
+    // Check whether the name is null-terminated within it's buffer.
+    if (!memchr(config.name, '\0', sizeof(config.name)))
+        return false;
+
+    // Check the invariants of all hall effect keys, which are the same ones enforced by the serial handler.
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        const HEKey &key = config.heKeys[i];
+        if (key.type != KeyType::HallEffect || key.index != i || key.macro > MACROS || key.color > 0xFFFFFF ||
+            key.smaExponent > SMA_FILTER_MAX_SAMPLE_EXPONENT)
+            return false;
+
+        // The sensitivities have to be within the tolerance-TRAVEL_DISTANCE_IN_0_01MM boundary.
+        if (key.rapidTriggerUpSensitivity < RAPID_TRIGGER_TOLERANCE || key.rapidTriggerUpSensitivity > TRAVEL_DISTANCE_IN_0_01MM ||
+            key.rapidTriggerDownSensitivity < RAPID_TRIGGER_TOLERANCE || key.rapidTriggerDownSensitivity > TRAVEL_DISTANCE_IN_0_01MM)
+            return false;
+
+        // The hysteresis have to be at least the hysteresis tolerance apart from each other and from the travel distance.
+        if (key.lowerHysteresis + HYSTERESIS_TOLERANCE > key.upperHysteresis || key.upperHysteresis + HYSTERESIS_TOLERANCE > TRAVEL_DISTANCE_IN_0_01MM)
+            return false;
+    }
+
+    // Check the invariants of all digital keys.
+    for (uint8_t i = 0; i < DIGITAL_KEYS; i++)
+    {
+        const DigitalKey &key = config.digitalKeys[i];
+        if (key.type != KeyType::Digital || key.index != i || key.macro > MACROS)
+            return false;
+    }
+
+    // Check the invariants of all macros.
+    for (const Macro &macro : config.macros)
+    {
+        if (macro.length > MACRO_STEPS)
+            return false;
+
+        for (uint8_t i = 0; i < macro.length; i++)
+            if (macro.steps[i].type > MacroStepType::Delay)
+                return false;
+    }
+
+    return true;
+}
+
+void ConfigurationController::exportConfig(ConfigurationBlob &blob) const
+{
+    // Convert the configuration into the persistent format and calculate the checksum over it.
+    pack(config, blob.config);
+    blob.crc = CRC32::compute(&blob.config, sizeof(blob.config));
+}
+
+bool ConfigurationController::importConfig(const ConfigurationBlob &blob)
+{
+    // Check whether the blob is intact and was exported by a firmware with the same configuration layout.
+    if (blob.crc != CRC32::compute(&blob.config, sizeof(blob.config)) || blob.config.version != defaultConfig.version)
+        return false;
+
+    // Convert the blob into a separate configuration first and only replace the configuration if it is valid,
+    // so the keypad either runs with the old or the whole new configuration, but never a mix of both.
+    static Configuration imported;
+    unpack(blob.config, imported);
+    if (!isValid(imported))
+        return false;
+
+    config = imported;
+    return true;
 }
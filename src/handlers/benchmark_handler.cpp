@@ -0,0 +1,136 @@
+#ifdef BENCHMARK
+#include <Arduino.h>
+#include "handlers/benchmark_handler.hpp"
+#include "handlers/keypad_handler.hpp"
+#include "handlers/serial_handler.hpp"
+#include "helpers/string_helper.hpp"
+extern "C"
+{
+#include "hardware/structs/xip_ctrl.h"
+}
+
+// Define a macro measuring the average amount of cycles of one iteration of the specified code. The interrupts are
+// disabled during the measurement to get stable results that are not influenced by the USB stack or timers.
+#define measure(code)                                   \
+    ({                                                  \
+        noInterrupts();                                 \
+        uint32_t start = rp2040.getCycleCount();        \
+        for (uint16_t i = 0; i < BENCHMARK_ITERATIONS; i++) \
+        {                                               \
+            code;                                       \
+        }                                               \
+        uint32_t cycles = rp2040.getCycleCount() - start; \
+        interrupts();                                   \
+        cycles / BENCHMARK_ITERATIONS;                  \
+    })
+
+void BenchmarkHandler::run(Print &output)
+{
+    // Measure the worst case of a full keypad scan, once with the XIP cache as left by the previous scan and once with
+    // the XIP cache flushed before every scan. The difference is the cost of the code of the scan path that is still
+    // executed from the flash. This runs real scans, which is why it is done before the key states are backed up.
+    report(output, "scanmax", 0, measureScan(false));
+    report(output, "scanflushedmax", 0, measureScan(true));
+
+    // Back up the key states and configuration, since the measured functions modify them. The keys used for the
+    // measurements have HID disabled so no key presses are sent to the host device while the benchmark is running.
+    static HEKeyState heKeyStates[HE_KEYS];
+    static DigitalKeyState digitalKeyStates[DIGITAL_KEYS];
+    static Configuration config;
+    memcpy(heKeyStates, KeypadHandler.heKeyStates, sizeof(heKeyStates));
+    memcpy(digitalKeyStates, KeypadHandler.digitalKeyStates, sizeof(digitalKeyStates));
+    config = ConfigController.config;
+
+    HEKey heKeys[HE_KEYS];
+    DigitalKey digitalKeys[DIGITAL_KEYS];
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        heKeys[i] = config.heKeys[i];
+        heKeys[i].hidEnabled = false;
+    }
+    for (uint8_t i = 0; i < DIGITAL_KEYS; i++)
+    {
+        digitalKeys[i] = config.digitalKeys[i];
+        digitalKeys[i].hidEnabled = false;
+    }
+
+    // Use separate filters for measuring the SMA filter, to not disturb the filters of the keys.
+    static SMAFilter filters[HE_KEYS];
+    static bool filtersInitialized = false;
+    if (!filtersInitialized)
+    {
+        for (SMAFilter &filter : filters)
+            filter = SMAFilter(SMA_FILTER_SAMPLE_EXPONENT);
+        filtersInitialized = true;
+    }
+
+    // Measure the hall effect key functions for every amount of keys, sweeping the values over the whole range.
+    // Results of functions without side effects are written into a volatile variable so they are not optimized away.
+    volatile uint16_t result;
+    for (uint8_t keys = 1; keys <= HE_KEYS; keys++)
+    {
+        report(output, "sma", keys, measure(for (uint8_t k = 0; k < keys; k++) result = filters[k](i << (ANALOG_RESOLUTION - 8))));
+        report(output, "map", keys, measure(for (uint8_t k = 0; k < keys; k++) result = KeypadHandler.mapSensorValueToTravelDistance(heKeys[k], i << (ANALOG_RESOLUTION - 8))));
+        report(output, "calibrate", keys, measure(for (uint8_t k = 0; k < keys; k++) KeypadHandler.calibrate(heKeys[k], i << (ANALOG_RESOLUTION - 8))));
+        report(output, "checkhekey", keys, measure(for (uint8_t k = 0; k < keys; k++) KeypadHandler.checkHEKey(heKeys[k], i * TRAVEL_DISTANCE_IN_0_01MM / BENCHMARK_ITERATIONS)));
+    }
+
+    // Measure the digital key check for every amount of keys, alternating between pressed and released.
+    for (uint8_t keys = 1; keys <= DIGITAL_KEYS; keys++)
+        report(output, "checkdigitalkey", keys, measure(for (uint8_t k = 0; k < keys; k++) KeypadHandler.checkDigitalKey(digitalKeys[k], i & 1)));
+
+    // Measure the string helpers and the serial input handling on a typical command. The copy of the input is
+    // measured separately and subtracted, since the functions modify the input and it has to be restored every iteration.
+    const char *command = "  HKEY1.RTUS   40  ";
+    char input[SERIAL_INPUT_BUFFER_SIZE];
+    char argument[SERIAL_INPUT_BUFFER_SIZE];
+    uint32_t copy = measure(strcpy(input, command));
+    report(output, "getargumentat", 0, measure(StringHelper::getArgumentAt(command, ' ', 3, argument)));
+    report(output, "tolower", 0, measure(strcpy(input, command); StringHelper::toLower(input)) - copy);
+    report(output, "makesafename", 0, measure(strcpy(input, command); StringHelper::makeSafename(input)) - copy);
+    report(output, "handleserialinput", 0, measure(strcpy(input, command); SerialHandler.handleSerialInput(input, output)) - copy);
+
+    (void)result;
+
+    // Restore the key states and configuration.
+    memcpy(KeypadHandler.heKeyStates, heKeyStates, sizeof(heKeyStates));
+    memcpy(KeypadHandler.digitalKeyStates, digitalKeyStates, sizeof(digitalKeyStates));
+    ConfigController.config = config;
+
+    output.println("BENCH END");
+}
+
+uint32_t BenchmarkHandler::measureScan(bool flush)
+{
+    // Run the scans with the interrupts enabled, since the HID report can not be sent without them. The interrupts
+    // influence the result of both measurements the same way, which is why the worst case is still comparable.
+    uint32_t worst = 0;
+    for (uint16_t i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        // Flush the XIP cache if requested. Reading the register back blocks until the flush is complete.
+        if (flush)
+        {
+            xip_ctrl_hw->flush = 1;
+            (void)xip_ctrl_hw->flush;
+        }
+
+        // Measure the scan and remember the longest one.
+        uint32_t start = rp2040.getCycleCount();
+        KeypadHandler.handle();
+        uint32_t cycles = rp2040.getCycleCount() - start;
+        if (cycles > worst)
+            worst = cycles;
+    }
+
+    return worst;
+}
+
+void BenchmarkHandler::report(Print &output, const char *name, uint8_t keys, uint32_t cycles)
+{
+    // Output the average amount of cycles of a measurement, with the amount of keys if the measurement depends on it.
+    if (keys == 0)
+        output.printf("BENCH %s=%lu\n", name, cycles);
+    else
+        output.printf("BENCH %s%d=%lu\n", name, keys, cycles);
+}
+#endif
@@ -0,0 +1,48 @@
+#include <Arduino.h>
+#include "handlers/boot_handler.hpp"
+#include "tusb.h"
+extern "C"
+{
+#include "pico/time.h"
+}
+
+void SCAN_FUNC(BootHandler::mark)(BootPhase phase)
+{
+    // Remember the time the phase was reached at for the first time.
+    if (!times[phase])
+        times[phase] = time_us_32();
+}
+
+void SCAN_FUNC(BootHandler::reported)()
+{
+    // Only the first report sent while the host device mounted the keypad is of interest, since reports
+    // sent before that are dropped by the USB stack and never reach the host device.
+    if (!times[BootPhase::FirstReport] && tud_mounted())
+        mark(BootPhase::FirstReport);
+}
+
+const char *BootHandler::getPhaseName(BootPhase phase)
+{
+    // Return a lowercase name of the phase for the serial output.
+    switch (phase)
+    {
+    case BootPhase::Setup:
+        return "setup";
+    case BootPhase::UsbStarted:
+        return "usb";
+    case BootPhase::ConfigLoaded:
+        return "config";
+    case BootPhase::HardwareReady:
+        return "hardware";
+    case BootPhase::SetupDone:
+        return "setupdone";
+    case BootPhase::ValidScan:
+        return "validscan";
+    case BootPhase::FirstReport:
+        return "report";
+    case BootPhase::Actuation:
+        return "actuation";
+    default:
+        return "unknown";
+    }
+}
@@ -1,14 +1,25 @@
 #include <Arduino.h>
-#include <Keyboard.h>
 #include "config/keys/key_type.hpp"
 #include "handlers/keypad_handler.hpp"
 #include "handlers/serial_handler.hpp"
+#include "handlers/macro_handler.hpp"
+#include "handlers/led_handler.hpp"
+#include "handlers/watchdog_handler.hpp"
+#include "handlers/latency_handler.hpp"
+#include "handlers/rapid_trigger_checker.hpp"
+#include "handlers/trace_handler.hpp"
+#include "handlers/boot_handler.hpp"
+#include "handlers/report_handler.hpp"
 #include "helpers/string_helper.hpp"
+#include "helpers/latency_probe.hpp"
 #include "definitions.hpp"
-
-// Constant two to the power of the ANALOG_RESOLUTION definition since calculating it every loop is too expensive.
-// Used to invert the read sensor value in case the INVERT_SENSOR_READINGS definition is set.
-const uint16_t TWO_EXP_ANALOG_RESOLUTION = pow(2, ANALOG_RESOLUTION);
+extern "C"
+{
+#include "hardware/sync.h"
+#include "hardware/adc.h"
+#include "hardware/gpio.h"
+#include "pico/time.h"
+}
 
 /*
    Explanation of the Rapid Trigger Logic
@@ -56,11 +67,45 @@ const uint16_t TWO_EXP_ANALOG_RESOLUTION = pow(2, ANALOG_RESOLUTION);
    Step 4: Depending on whether the key is pressed or not, remember the lowest/highest peak achieved
 */
 
-void KeypadHandler::handle()
+void SCAN_FUNC(KeypadHandler::handle)()
 {
+    // Reset the activity state, which is set again if any key is touched during this scan.
+    active = false;
+
+    // Go through all digital keys and run the checks first. They only take a GPIO read each, which is why they are
+    // checked before the analog work of the hall effect keys, so their changes can be reported right away.
+    for (const DigitalKey &key : ConfigController.config.digitalKeys)
+    {
+        // Read the digital value from the key pin.
+        bool pressed = readKey(key);
+
+        // Run the checks on the digital key.
+        checkDigitalKey(key, pressed);
+
+        // The key is considered active if it is pressed down or the pin changed since the last scan.
+        if (pressed || pressed != digitalKeyStates[key.index].lastReading)
+            active = true;
+        digitalKeyStates[key.index].lastReading = pressed;
+    }
+
+    // Submit the changes of the digital keys to the HID interface immediately instead of after the hall effect keys, meaning
+    // the latency of the digital keys is only bound by the polling of the host device. Then continue with the scan.
+    if (ReportHandler.isChanged())
+    {
+        report();
+        WatchdogHandler.enter(LoopPhase::Scanning);
+    }
+
+    // Bool whether the values of all hall effect keys are valid in this scan, for the boot metrics.
+    bool valid = true;
+
     // Go through all hall effect keys and run the checks.
     for (const HEKey &key : ConfigController.config.heKeys)
     {
+        // Apply the configured amount of samples to the SMA filter if it changed, e.g. via the serial interface.
+        if (heKeyStates[key.index].filter.getSamplesExponent() != key.smaExponent)
+            heKeyStates[key.index].filter.setSamplesExponent(key.smaExponent);
+
         // Read the value from the hall effect sensor and map it to the travel distance range.
         uint16_t value = readKey(key);
         uint16_t mappedValue = mapSensorValueToTravelDistance(key, value);
@@ -69,37 +114,75 @@ void KeypadHandler::handle()
         heKeyStates[key.index].lastSensorValue = value;
         heKeyStates[key.index].lastMappedValue = mappedValue;
 
-        // If the output mode is enabled, output the raw and mapped values.
-        if (outputMode)
-            SerialHandler.printHEKeyOutput(key);
-
-        // Only go further if the keys' SMA filter is fully initialized.
-        // This is necessary to ensure that read values are not influenced by default zeroes in the filters' buffer.
+        // Only go further if the keys' SMA filter is initialized. Since the filter is seeded with the first value
+        // read from the sensor, this is the case starting with the very first scan after bootup.
         if (!heKeyStates[key.index].filter.initialized)
+        {
+            valid = false;
             continue;
+        }
 
         // Make sure to run checks on the calibration values, updating them if available.
         calibrate(key, value);
 
-        // Run the checks on the HE key.
+        // Run the checks on the HE key. If the rapid trigger checker is enabled, verify the invariants of the logic afterwards.
+#ifdef RAPID_TRIGGER_CHECK
+        bool wasPressed = heKeyStates[key.index].pressed;
+        uint16_t previousPeak = heKeyStates[key.index].rapidTriggerPeak;
         checkHEKey(key, heKeyStates[key.index].lastMappedValue);
+        RapidTriggerChecker.check(key, wasPressed, previousPeak, heKeyStates[key.index], heKeyStates[key.index].lastMappedValue);
+#else
+        checkHEKey(key, heKeyStates[key.index].lastMappedValue);
+#endif
+
+        // The key is considered active if it left the rest band at the top, the same band used to fully release
+        // the key in continuous rapid trigger mode, or is still pressed down.
+        if (mappedValue < TRAVEL_DISTANCE_IN_0_01MM - CONTINUOUS_RAPID_TRIGGER_THRESHOLD || heKeyStates[key.index].pressed)
+            active = true;
     }
 
-    // Go through all digital keys and run the checks.
-    for (const DigitalKey &key : ConfigController.config.digitalKeys)
-    {
-        // Read the digital value from the key pin.
-        bool pressed = readKey(key);
+    // Remember the time of the first scan in which all hall effect keys were checked.
+    if (valid)
+        BootHandler.mark(BootPhase::ValidScan);
 
-        // Run the checks on the digital key.
-        checkDigitalKey(key, pressed);
-    }
+    // Publish the travel distance and pressed state of the hall effect keys to the LEDs.
+    LEDHandler.publish(heKeyStates);
+
+    // Record the values of the hall effect keys into the trace, if a recording is running.
+#ifdef TRACE_RECORDER
+    TraceHandler.record(heKeyStates);
+#endif
 
-    // Send the key report via the HID interface after updating the report.
-    Keyboard.sendReport();
+    // Publish the consistent snapshot of this scan for readers outside of the keypad scan.
+    publishSnapshot();
+
+    // Apply the key events of running macros, queued by the macro timer since the last scan.
+    MacroHandler.apply();
+
+    // Send the key report via the HID interface after updating the report with the hall effect keys and macros.
+    report();
+}
+
+void SCAN_FUNC(KeypadHandler::report)()
+{
+    // Send the key report via the HID interface. The report is only submitted if it changed and is retried in the
+    // next scan if the host device did not poll the previous one yet, in which case nothing was reported.
+    WatchdogHandler.enter(LoopPhase::Reporting);
+    uint32_t reports = ReportHandler.reports;
+    if (!ReportHandler.send())
+        return;
+
+    LatencyProbe::reported();
+
+    // Only count reports that were actually submitted for the boot metrics, not scans in which the report was unchanged.
+    if (ReportHandler.reports != reports)
+        BootHandler.reported();
+
+    // Account the latency from the actuation decisions to the submission of the report.
+    LatencyHandler.reported();
 }
 
-void KeypadHandler::calibrate(const HEKey &key, uint16_t value)
+void SCAN_FUNC(KeypadHandler::calibrate)(const HEKey &key, uint16_t value)
 {
     // Calculate the value with the deadzone in the positive and negative direction applied.
     uint16_t upperValue = value - AUTO_CALIBRATION_DEADZONE;
@@ -116,7 +199,7 @@ void KeypadHandler::calibrate(const HEKey &key, uint16_t value)
         heKeyStates[key.index].downPosition = lowerValue;
 }
 
-void KeypadHandler::checkHEKey(const HEKey &key, uint16_t value)
+void SCAN_FUNC(KeypadHandler::checkHEKey)(const HEKey &key, uint16_t value)
 {
     // If the key is in traditional mode, do the usual hysteresis checks.
     if (!key.rapidTrigger)
@@ -169,19 +252,20 @@ void KeypadHandler::checkHEKey(const HEKey &key, uint16_t value)
         heKeyStates[key.index].rapidTriggerPeak = value;
 }
 
-void KeypadHandler::checkDigitalKey(const DigitalKey &key, bool pressed)
+void SCAN_FUNC(KeypadHandler::checkDigitalKey)(const DigitalKey &key, bool pressed)
 {
     // Check whether the key is pressed and send the HID command.
-    if (pressed && millis() - digitalKeyStates[key.index].lastDebounce >= DIGITAL_DEBOUNCE_DELAY)
+    // The microsecond timer is read directly, since millis() is executed from the flash.
+    if (pressed && time_us_32() - digitalKeyStates[key.index].lastDebounce >= DIGITAL_DEBOUNCE_DELAY * 1000)
     {
         pressKey(key);
-        digitalKeyStates[key.index].lastDebounce = millis();
+        digitalKeyStates[key.index].lastDebounce = time_us_32();
     }
     else if (!pressed)
         releaseKey(key);
 }
 
-void KeypadHandler::pressKey(const Key &key)
+void SCAN_FUNC(KeypadHandler::pressKey)(const Key &key)
 {
     // Get the pointer to the correct pressed bool depending on the key type.
     // In case the key type is neither digital or hall effect (which shouldn't happen),
@@ -194,12 +278,35 @@ void KeypadHandler::pressKey(const Key &key)
     if (!pressed || *pressed || !key.hidEnabled)
         return;
 
-    // Send the HID instruction to the computer.
     *pressed = true;
-    Keyboard.press(key.keyChar);
+
+    // Remember the time of the first key press for the boot metrics. Presses of hall effect keys only count once the calibration
+    // is valid, meaning the down position was calibrated below the rest position, since the mapped value is meaningless before.
+    if (key.type != KeyType::HallEffect || heKeyStates[key.index].downPosition < heKeyStates[key.index].restPosition)
+        BootHandler.mark(BootPhase::Actuation);
+
+    // Send the HID instruction to the computer. If a macro is assigned to the key, trigger
+    // it instead. The macro is played back by the macro handler without blocking the scan.
+    KeyState *state = key.type == KeyType::HallEffect ? (KeyState *)&heKeyStates[key.index] : &digitalKeyStates[key.index];
+    if (key.macro)
+    {
+        // Remember that nothing was pressed in the report, so nothing is released either.
+        state->reportedCode = 0;
+        state->reportedModifiers = 0;
+        MacroHandler.trigger(key.macro - 1);
+    }
+    else
+    {
+        // Press the usage code and modifiers precompiled in the configuration, remembering them for the release.
+        state->reportedCode = key.keyCode;
+        state->reportedModifiers = key.keyModifiers;
+        LatencyProbe::decided(LatencyHandler::getKey(key));
+        ReportHandler.press(key.keyCode, key.keyModifiers);
+        LatencyHandler.decided(LatencyHandler::getKey(key));
+    }
 }
 
-void KeypadHandler::releaseKey(const Key &key)
+void SCAN_FUNC(KeypadHandler::releaseKey)(const Key &key)
 {
     // Get the pointer to the correct pressed bool depending on the key type.
     // In case the key type is neither digital or hall effect (which shouldn't happen),
@@ -212,33 +319,51 @@ void KeypadHandler::releaseKey(const Key &key)
     if (!pressed || !*pressed)
         return;
 
-    // Send the HID instruction to the computer.
-    Keyboard.release(key.keyChar);
+    // Send the HID instruction to the computer, releasing exactly the usage code and modifiers that were pressed, even if the
+    // configuration changed in the meantime. Keys that triggered a macro have nothing to release, since the macro releases
+    // its key chars on it's own.
+    KeyState *state = key.type == KeyType::HallEffect ? (KeyState *)&heKeyStates[key.index] : &digitalKeyStates[key.index];
+    if (state->reportedCode || state->reportedModifiers)
+    {
+        LatencyProbe::decided(LatencyHandler::getKey(key));
+        ReportHandler.release(state->reportedCode, state->reportedModifiers);
+        LatencyHandler.decided(LatencyHandler::getKey(key));
+        state->reportedCode = 0;
+        state->reportedModifiers = 0;
+    }
     *pressed = false;
 }
 
-uint16_t KeypadHandler::readKey(const Key &key)
+uint16_t SCAN_FUNC(KeypadHandler::readKey)(const Key &key)
 {
     // Perform a digital read if the key is a digital one.
     if (key.type == KeyType::Digital)
     {
         // Read the digital key and return 0 or 1 depending on whether the signal is HIGH or LOW.
-        return !digitalRead(DIGITAL_PIN(key.index));
+        // The GPIO is read directly since digitalRead() is executed from the flash and validates the pin every call.
+        return !gpio_get(DIGITAL_PIN(key.index));
     }
     // Perform an analog read if the key is a hall effect one.
     else if (key.type == KeyType::HallEffect)
     {
-        // Read the value from the port of the specified key.
-        uint16_t value = analogRead(HE_PIN(key.index));
+        // Read the value from the port of the specified key. The ADC is read directly since analogRead() is executed
+        // from the flash and initializes the pin every call. The ADC is set up in the setup() function of the firmware.
+        adc_select_input(HE_PIN(key.index) - A0);
+#if ANALOG_RESOLUTION < 12
+        uint16_t value = adc_read() >> (12 - ANALOG_RESOLUTION);
+#else
+        uint16_t value = adc_read() << (ANALOG_RESOLUTION - 12);
+#endif
 
         // Invert the value if the definition is set since in rare fields of application the sensor
         // is mounted the other way around, resulting in a different polarity and inverted sensor readings.
         // Since this firmware expects the value to go down when the button is pressed down, this is needed.
 #ifdef INVERT_SENSOR_READINGS
-        value = TWO_EXP_ANALOG_RESOLUTION - 1 - value;
+        value = ANALOG_MAX_VALUE - value;
 #endif
 
-        // Filter the value through the SMA filter and return it.
+        // Remember the raw value, then filter the value through the SMA filter and return it.
+        heKeyStates[key.index].lastRawValue = value;
         return heKeyStates[key.index].filter(value);
     }
     // Otherwise, in case anything goes wrong, default to 0.
@@ -246,9 +371,53 @@ uint16_t KeypadHandler::readKey(const Key &key)
         return 0;
 }
 
-uint16_t KeypadHandler::mapSensorValueToTravelDistance(const HEKey &key, uint16_t value) const
+void SCAN_FUNC(KeypadHandler::publishSnapshot)()
+{
+    // Make the sequence odd to signalize readers that the snapshot is being written. The memory barriers make sure
+    // the writes to the snapshot are not reordered around the writes to the sequence, including across cores.
+    snapshotSequence = snapshotSequence + 1;
+    __dmb();
+
+    // Copy the values of interest of all keys into the snapshot.
+    snapshot.scan++;
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        const HEKeyState &state = heKeyStates[i];
+        snapshot.heKeys[i] = {state.pressed, state.lastRawValue, state.lastSensorValue, state.lastMappedValue, state.restPosition, state.downPosition};
+    }
+
+    snapshot.digitalKeys = 0;
+    for (uint8_t i = 0; i < DIGITAL_KEYS; i++)
+        snapshot.digitalKeys |= (uint32_t)digitalKeyStates[i].pressed << i;
+
+    // Make the sequence even again to signalize readers that the snapshot is consistent.
+    __dmb();
+    snapshotSequence = snapshotSequence + 1;
+}
+
+void KeypadHandler::getSnapshot(KeypadSnapshot &output) const
+{
+    // Copy the snapshot until it was not written while copying it. This only retries if a scan on another core or
+    // in an interrupt published a new snapshot in the meantime, which is short compared to the scan interval.
+    uint32_t sequence;
+    do
+    {
+        sequence = snapshotSequence;
+        __dmb();
+        output = snapshot;
+        __dmb();
+    } while ((sequence & 1) || sequence != snapshotSequence);
+}
+
+uint16_t SCAN_FUNC(KeypadHandler::mapSensorValueToTravelDistance)(const HEKey &key, uint16_t value) const
 {
     // Map the value with the calibrated down and rest position values to a range between 0 and TRAVEL_DISTANCE_IN_0_01MM and constrain it.
     // This is done to guarantee that the unit for the numbers used across the firmware actually matches the milimeter metric.
-    return constrain(map(value, heKeyStates[key.index].downPosition, heKeyStates[key.index].restPosition, 0, TRAVEL_DISTANCE_IN_0_01MM), 0, TRAVEL_DISTANCE_IN_0_01MM);
+    // The mapping is calculated inline instead of using map() and constrain(), since these are executed from the flash.
+    int32_t down = heKeyStates[key.index].downPosition;
+    int32_t rest = heKeyStates[key.index].restPosition;
+    if (rest == down)
+        return 0;
+    int32_t distance = ((int32_t)value - down) * TRAVEL_DISTANCE_IN_0_01MM / (rest - down);
+    return distance < 0 ? 0 : distance > TRAVEL_DISTANCE_IN_0_01MM ? TRAVEL_DISTANCE_IN_0_01MM : distance;
 }
@@ -0,0 +1,45 @@
+#include <Arduino.h>
+#include "handlers/latency_handler.hpp"
+extern "C"
+{
+#include "pico/time.h"
+}
+
+void SCAN_FUNC(LatencyHandler::decided)(uint8_t key)
+{
+    // Remember the time of the decision, unless the key already has one waiting for the next HID report.
+    // In that case, the report will contain the result of both decisions and the older one is the relevant one.
+    if (pending & (1UL << key))
+        return;
+
+    decisionTimes[key] = time_us_32();
+    pending |= 1UL << key;
+}
+
+void SCAN_FUNC(LatencyHandler::reported)()
+{
+    // Return early if no decision is waiting for the HID report, which is the case on most scans.
+    if (!pending)
+        return;
+
+    // Add the time from the decision to the submission of the HID report of every pending key to it's histogram.
+    uint32_t now = time_us_32();
+    for (uint8_t i = 0; i < LATENCY_KEYS; i++)
+    {
+        if (!(pending & (1UL << i)))
+            continue;
+
+        // Get the log2 bucket of the latency by the position of the highest set bit, clamped to the last bucket.
+        uint32_t latency = now - decisionTimes[i];
+        uint8_t bucket = latency == 0 ? 0 : 32 - __builtin_clz(latency);
+        histograms[i][bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1]++;
+    }
+
+    pending = 0;
+}
+
+void LatencyHandler::reset()
+{
+    // Clear all histograms.
+    memset(histograms, 0, sizeof(histograms));
+}
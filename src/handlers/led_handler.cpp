@@ -0,0 +1,106 @@
+#include <Arduino.h>
+#include "handlers/led_handler.hpp"
+#include "pio/ws2812.pio.h"
+extern "C"
+{
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+}
+
+// The bit rate of the WS2812 data line in bits per second.
+#define WS2812_FREQUENCY 800000
+
+void LEDHandler::begin()
+{
+    // Claim a state machine, load the WS2812 program and let the state machine drive the LED pin via side-set.
+    sm = pio_claim_unused_sm(pio, true);
+    uint offset = pio_add_program(pio, &ws2812_program);
+    pio_gpio_init(pio, LED_PIN);
+    pio_sm_set_consecutive_pindirs(pio, sm, LED_PIN, 1, true);
+
+    // Shift out the 24 bits of a color MSB-first, pulling the next color automatically and joining the FIFOs for a deeper TX FIFO.
+    pio_sm_config config = ws2812_program_get_default_config(offset);
+    sm_config_set_sideset_pins(&config, LED_PIN);
+    sm_config_set_out_shift(&config, false, true, 24);
+    sm_config_set_fifo_join(&config, PIO_FIFO_JOIN_TX);
+    pio_sm_init(pio, sm, offset, &config);
+    updateClock();
+    pio_sm_set_enabled(pio, sm, true);
+
+    // Configure a DMA channel feeding the frame buffer into the TX FIFO of the state machine, paced by it's data request signal.
+    dmaChannel = dma_claim_unused_channel(true);
+    dma_channel_config dmaConfig = dma_channel_get_default_config(dmaChannel);
+    channel_config_set_transfer_data_size(&dmaConfig, DMA_SIZE_32);
+    channel_config_set_read_increment(&dmaConfig, true);
+    channel_config_set_write_increment(&dmaConfig, false);
+    channel_config_set_dreq(&dmaConfig, pio_get_dreq(pio, sm, true));
+    dma_channel_configure(dmaChannel, &dmaConfig, &pio->txf[sm], frame, HE_KEYS, false);
+
+    // Start the repeating timer computing the frames. A negative delay keeps the frame rate steady.
+    add_repeating_timer_us(-1000000 / LED_FRAME_RATE, tick, this, &timer);
+}
+
+void LEDHandler::updateClock()
+{
+    // Calculate the clock divider of the state machine for the WS2812 bit rate from the current system clock.
+    // The divider is split into the integer and 1/256 fractional part to not require any floating point math.
+    uint32_t cyclesPerSecond = WS2812_FREQUENCY * (ws2812_T1 + ws2812_T2 + ws2812_T3);
+    uint32_t systemClock = clock_get_hz(clk_sys);
+    pio_sm_set_clkdiv_int_frac(pio, sm, systemClock / cyclesPerSecond, (systemClock % cyclesPerSecond) * 256 / cyclesPerSecond);
+}
+
+void SCAN_FUNC(LEDHandler::publish)(const HEKeyState *states)
+{
+    uint32_t start = rp2040.getCycleCount();
+
+    // Pack the state of every hall effect key into a single word and publish it for the timer.
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        keyStates[i] = (uint32_t)states[i].pressed << 16 | states[i].lastMappedValue;
+
+    // Remember the cost of publishing the key states.
+    lastPublishCycles = rp2040.getCycleCount() - start;
+    if (lastPublishCycles > maxPublishCycles)
+        maxPublishCycles = lastPublishCycles;
+}
+
+bool LEDHandler::tick(repeating_timer_t *timer)
+{
+    LEDHandler *handler = (LEDHandler *)timer->user_data;
+
+    // Skip the frame if the previous one is still being shifted out, otherwise compute the frame and start the DMA.
+    if (dma_channel_is_busy(handler->dmaChannel))
+        handler->skippedFrames++;
+    else
+    {
+        handler->render();
+        dma_channel_set_read_addr(handler->dmaChannel, handler->frame, true);
+        handler->frames++;
+    }
+
+    // Return true to keep the repeating timer running.
+    return true;
+}
+
+void LEDHandler::render()
+{
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        // Unpack the published key state.
+        uint32_t state = keyStates[i];
+        bool pressed = state >> 16;
+        uint16_t travel = state & 0xFFFF;
+
+        // Calculate the intensity of the LED from 0-255. The further the key is pressed down, the brighter the LED gets.
+        // While the key is pressed, an additional quarter of the intensity is added to make actuations visible.
+        uint32_t intensity = (uint32_t)(TRAVEL_DISTANCE_IN_0_01MM - travel) * 191 / TRAVEL_DISTANCE_IN_0_01MM + (pressed ? 64 : 0);
+        intensity = intensity * ConfigController.config.ledBrightness / 255;
+
+        // Scale the color channels of the key by the intensity and write them in the GRB order expected by the WS2812.
+        // The colors are shifted to the upper 24 bits since the state machine shifts the bits out MSB-first.
+        uint32_t color = ConfigController.config.heKeys[i].color;
+        uint32_t red = (color >> 16 & 0xFF) * intensity / 255;
+        uint32_t green = (color >> 8 & 0xFF) * intensity / 255;
+        uint32_t blue = (color & 0xFF) * intensity / 255;
+        frame[i] = (green << 16 | red << 8 | blue) << 8;
+    }
+}
@@ -0,0 +1,169 @@
+#include <Arduino.h>
+#include "handlers/macro_handler.hpp"
+#include "handlers/report_handler.hpp"
+#include "helpers/hid_helper.hpp"
+extern "C"
+{
+#include "hardware/sync.h"
+}
+
+void MacroHandler::begin()
+{
+    // Start the repeating timer that plays back the macros. A negative delay makes the timer schedule the
+    // next call relative to the start of the previous one, keeping the tick rate steady.
+    add_repeating_timer_us(-MACRO_TICK_INTERVAL_US, tick, this, &timer);
+}
+
+void SCAN_FUNC(MacroHandler::trigger)(uint8_t index)
+{
+    // Ignore invalid indices and macros that are already being played back or about to be.
+    if (index >= MACROS || players[index].running || pendingStarts[index])
+        return;
+
+    // Take a copy of the macro for the playback, then request the start of the macro. The playback itself is started
+    // on the next tick of the timer. The barrier makes sure the copy is complete before the timer can see the request.
+    players[index].macro = ConfigController.config.macros[index];
+    __dmb();
+    pendingStarts[index] = true;
+}
+
+bool SCAN_FUNC(MacroHandler::apply)()
+{
+    // Remember whether any event was applied to the HID report.
+    bool applied = false;
+
+    // Start collecting the pressed keys anew once the report containing the previous presses was submitted.
+    if (ReportHandler.reports != batchReport)
+    {
+        memset(batchCodes, 0, sizeof(batchCodes));
+        batchModifiers = 0;
+        batchReport = ReportHandler.reports;
+    }
+
+    // Apply the key events queued by the timer to the HID report, in the order they were produced.
+    while (eventTail != eventHead)
+    {
+        const MacroEvent &event = events[eventTail];
+        // Only remember presses that changed the report, since only those have to be seen by the host device before their release.
+        // Presses of keys already held by another key or dropped because of a full report would hold back the release until
+        // another key changes the report, which may never happen.
+        if (event.press)
+        {
+            if (ReportHandler.press(event.code, event.modifiers))
+            {
+                batchCodes[event.code >> 5] |= 1UL << (event.code & 31);
+                batchModifiers |= event.modifiers;
+            }
+        }
+        else
+        {
+            // Stop at the release of a key that was pressed since the last submitted report, so the press and release do not
+            // cancel each other out in the same report. The remaining events are applied after the report was submitted.
+            if ((event.code && batchCodes[event.code >> 5] & (1UL << (event.code & 31))) || event.modifiers & batchModifiers)
+                break;
+
+            ReportHandler.release(event.code, event.modifiers);
+        }
+
+        // Move the tail forward after the event was consumed, releasing the slot for the timer.
+        eventTail = (eventTail + 1) % MACRO_EVENT_QUEUE_SIZE;
+        applied = true;
+    }
+
+    return applied;
+}
+
+bool MacroHandler::tick(repeating_timer_t *timer)
+{
+    // Get the macro handler instance passed as the user data and the current time.
+    MacroHandler *handler = (MacroHandler *)timer->user_data;
+    uint32_t now = time_us_32();
+
+    // Go through all macros, start the requested ones and advance the running ones.
+    for (uint8_t i = 0; i < MACROS; i++)
+    {
+        if (handler->pendingStarts[i])
+        {
+            handler->pendingStarts[i] = false;
+            handler->players[i].step = 0;
+            handler->players[i].dueAt = now;
+            handler->players[i].running = true;
+        }
+
+        if (handler->players[i].running)
+            handler->advance(i, now);
+    }
+
+    // Return true to keep the repeating timer running.
+    return true;
+}
+
+void MacroHandler::advance(uint8_t index, uint32_t now)
+{
+    MacroPlayer &player = players[index];
+    const Macro &macro = player.macro;
+
+    // Execute all steps that are due, stopping at the first delay that has not elapsed yet.
+    // The signed difference handles the wrap-around of the 32-bit microsecond timer.
+    while ((int32_t)(now - player.dueAt) >= 0)
+    {
+        // If all steps have been executed, release the key chars the macro did not release on it's own, so a macro without
+        // the release steps can not hold a key forever, and the playback of the macro is finished. If the queue is full,
+        // the remaining releases are retried on the next tick.
+        if (player.step >= macro.length || player.step >= MACRO_STEPS)
+        {
+            for (uint16_t keyChar = 0; keyChar < 256; keyChar++)
+            {
+                if (!(player.held[keyChar >> 5] & (1UL << (keyChar & 31))))
+                    continue;
+
+                if (!push(false, (char)keyChar))
+                    return;
+                player.held[keyChar >> 5] &= ~(1UL << (keyChar & 31));
+            }
+
+            player.running = false;
+            return;
+        }
+
+        // Queue press and release steps for the keypad handler and push the due time back on delay steps. If the queue
+        // is full, because the keypad handler holds back releases until the host device saw the press, retry on the next tick.
+        // Key chars are only pressed if not held by the macro yet and only released if held, so presses and releases balance.
+        const MacroStep &step = macro.steps[player.step];
+        uint8_t keyChar = step.value;
+        uint32_t mask = 1UL << (keyChar & 31);
+        bool held = player.held[keyChar >> 5] & mask;
+        if (step.type == MacroStepType::Delay)
+            player.dueAt += step.value * 1000;
+        else if (step.type == MacroStepType::Press && !held)
+        {
+            if (!push(true, (char)keyChar))
+                return;
+            player.held[keyChar >> 5] |= mask;
+        }
+        else if (step.type == MacroStepType::Release && held)
+        {
+            if (!push(false, (char)keyChar))
+                return;
+            player.held[keyChar >> 5] &= ~mask;
+        }
+
+        player.step++;
+    }
+}
+
+bool MacroHandler::push(bool press, char keyChar)
+{
+    // Refuse the event if the queue is full, which happens if the keypad handler did not consume the previous events yet.
+    uint8_t next = (eventHead + 1) % MACRO_EVENT_QUEUE_SIZE;
+    if (next == eventTail)
+        return false;
+
+    // Write the event with the usage code and modifiers of the key char, so the keypad handler only has to apply them,
+    // and only then move the head forward, publishing it to the keypad handler.
+    uint8_t code, modifiers;
+    HIDHelper::getUsage(keyChar, &code, &modifiers);
+    events[eventHead] = {press, code, modifiers};
+    eventHead = next;
+    return true;
+}
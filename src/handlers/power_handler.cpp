@@ -0,0 +1,52 @@
+#include <Arduino.h>
+#include "handlers/power_handler.hpp"
+#include "handlers/led_handler.hpp"
+extern "C"
+{
+#include "pico/time.h"
+#include "hardware/clocks.h"
+}
+
+void SCAN_FUNC(PowerHandler::update)(bool active, uint32_t scanStart)
+{
+    // If any key was active in the last scan, remember the time and wake the keypad up if it is idle.
+    if (active)
+    {
+        lastActivity = millis();
+        if (idle)
+            exitIdle(scanStart);
+
+        return;
+    }
+
+    // If the keypad is not idle yet, check whether the idle timeout elapsed. An idle timeout of 0 disables the idle mode.
+    // While idle, the scheduler scans at the idle scan interval and sleeps in between.
+    if (!idle && ConfigController.config.idleTimeout != 0 && millis() - lastActivity >= ConfigController.config.idleTimeout * 1000UL)
+        enterIdle();
+}
+
+void PowerHandler::enterIdle()
+{
+    // Lower the system clock and update the clock divider of the LEDs since their timing depends on it.
+    // If the clock can not be set, the keypad still goes idle but only scans at the reduced rate.
+    if (set_sys_clock_khz(IDLE_CLOCK_KHZ, false))
+        LEDHandler.updateClock();
+
+    idle = true;
+    entries++;
+}
+
+void PowerHandler::exitIdle(uint32_t scanStart)
+{
+    // Restore the full system clock and update the clock divider of the LEDs.
+    set_sys_clock_khz(F_CPU / 1000, true);
+    LEDHandler.updateClock();
+
+    idle = false;
+    exits++;
+
+    // Remember the time it took from the start of the scan that detected the activity until the full clock was restored.
+    lastWakeLatency = time_us_32() - scanStart;
+    if (lastWakeLatency > maxWakeLatency)
+        maxWakeLatency = lastWakeLatency;
+}
@@ -0,0 +1,35 @@
+#ifdef RAPID_TRIGGER_CHECK
+#include <Arduino.h>
+#include "handlers/rapid_trigger_checker.hpp"
+
+void SCAN_FUNC(RapidTriggerChecker::check)(const HEKey &key, bool wasPressed, uint16_t previousPeak, const HEKeyState &state, uint16_t value)
+{
+    // Get the point above which the key always has to be released. In continuous rapid trigger mode, this
+    // is the fully released threshold, otherwise the upper hysteresis, since the rapid trigger zone is left there.
+    uint16_t releasePoint = key.rapidTrigger && key.continuousRapidTrigger ? TRAVEL_DISTANCE_IN_0_01MM - CONTINUOUS_RAPID_TRIGGER_THRESHOLD
+                                                                           : key.upperHysteresis;
+
+    // A press is only valid if the value is below the lower hysteresis or, in rapid trigger mode, the key
+    // travelled down by at least the down sensitivity from the highest peak recorded.
+    if (!wasPressed && state.pressed && value > key.lowerHysteresis &&
+        (!key.rapidTrigger || value + key.rapidTriggerDownSensitivity > previousPeak))
+        violations[key.index][RapidTriggerViolation::UnexpectedPress]++;
+
+    // A release is only valid if the value is above the release point or, in rapid trigger mode, the key
+    // travelled up by at least the up sensitivity from the lowest peak recorded.
+    if (wasPressed && !state.pressed && value < releasePoint &&
+        (!key.rapidTrigger || value < previousPeak + key.rapidTriggerUpSensitivity))
+        violations[key.index][RapidTriggerViolation::UnexpectedRelease]++;
+
+    // A key above the release point must never stay pressed. Since the upper hysteresis is always at least the hysteresis
+    // tolerance below the travel distance, this point is always reachable and a violation means the key would be stuck.
+    if (state.pressed && value >= releasePoint)
+        violations[key.index][RapidTriggerViolation::StuckKey]++;
+}
+
+void RapidTriggerChecker::reset()
+{
+    // Clear all violation counters.
+    memset(violations, 0, sizeof(violations));
+}
+#endif
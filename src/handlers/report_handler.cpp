@@ -0,0 +1,100 @@
+#include <Arduino.h>
+#include <CoreMutex.h>
+#include <RP2040USB.h>
+#include "handlers/report_handler.hpp"
+#include "tusb.h"
+
+// The mutex of the USB stack of the core, which has to be held while using TinyUSB outside of it's task.
+extern mutex_t __usb_mutex;
+
+bool SCAN_FUNC(ReportHandler::press)(uint8_t code, uint8_t modifiers)
+{
+    // Hold the modifier bits, counting the keys holding each of them. Returns whether the report changed, since the press
+    // of a usage code or modifier already held by another key or dropped because of a full report changes nothing.
+    bool changed = false;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        if (modifiers & (1 << i) && modifierCounts[i]++ == 0)
+        {
+            this->modifiers |= 1 << i;
+            dirty = true;
+            changed = true;
+        }
+    }
+
+    // Keys only consisting of modifiers do not occupy a key slot.
+    if (code == 0)
+        return changed;
+
+    // If the usage code is already in the report, count the key on it's slot. Otherwise, use the first free slot.
+    uint8_t freeSlot = REPORT_KEYS;
+    for (uint8_t i = 0; i < REPORT_KEYS; i++)
+    {
+        if (keys[i] == code)
+        {
+            keyCounts[i]++;
+            return changed;
+        }
+        else if (keys[i] == 0 && freeSlot == REPORT_KEYS)
+            freeSlot = i;
+    }
+
+    // Drop the press if all slots are in use, since the report can not hold more keys at once.
+    if (freeSlot == REPORT_KEYS)
+    {
+        overflows++;
+        return changed;
+    }
+
+    keys[freeSlot] = code;
+    keyCounts[freeSlot] = 1;
+    dirty = true;
+    return true;
+}
+
+void SCAN_FUNC(ReportHandler::release)(uint8_t code, uint8_t modifiers)
+{
+    // Release the modifier bits once no key holds them anymore.
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        if (modifiers & (1 << i) && modifierCounts[i] > 0 && --modifierCounts[i] == 0)
+        {
+            this->modifiers &= ~(1 << i);
+            dirty = true;
+        }
+    }
+
+    // Free the slot of the usage code once no key holds it anymore. Codes not in the report were dropped on the press.
+    if (code == 0)
+        return;
+
+    for (uint8_t i = 0; i < REPORT_KEYS; i++)
+    {
+        if (keys[i] == code)
+        {
+            if (--keyCounts[i] == 0)
+            {
+                keys[i] = 0;
+                dirty = true;
+            }
+            return;
+        }
+    }
+}
+
+bool SCAN_FUNC(ReportHandler::send)()
+{
+    // Only submit the report if it changed, returning whether the host device gets the latest state of the report.
+    if (!dirty)
+        return true;
+
+    // If the host device did not poll the previous report yet, keep the report changed so it is submitted in one of the next scans.
+    CoreMutex m(&__usb_mutex);
+    if (!tud_hid_ready())
+        return false;
+
+    tud_hid_keyboard_report(__USBGetKeyboardReportID(), modifiers, keys);
+    dirty = false;
+    reports++;
+    return true;
+}
@@ -0,0 +1,97 @@
+#include <Arduino.h>
+#include "handlers/scheduler_handler.hpp"
+#include "handlers/power_handler.hpp"
+#include "handlers/watchdog_handler.hpp"
+extern "C"
+{
+#include "pico/time.h"
+}
+
+void SchedulerHandler::begin(void (*scan)())
+{
+    // Remember the scan function and make the first scan due immediately.
+    this->scan = scan;
+    nextScan = time_us_32();
+}
+
+void SchedulerHandler::addTask(const char *name, void (*function)(), uint32_t budget)
+{
+    // Add the task if there is space left for it.
+    if (taskCount < SCHEDULER_TASKS)
+        tasks[taskCount++] = {name, function, budget, 0, 0, 0, 0};
+}
+
+void SCAN_FUNC(SchedulerHandler::run)()
+{
+    // Run the scan, counting it as late if it starts more than a whole scan interval after it was due.
+    uint32_t interval = PowerHandler.idle ? IDLE_SCAN_INTERVAL_US : SCAN_INTERVAL_US;
+    uint32_t start = time_us_32();
+    if ((int32_t)(start - nextScan) > (int32_t)interval)
+        lateScans++;
+
+    scan();
+    scans++;
+
+    uint32_t duration = time_us_32() - start;
+    if (duration > maxScanDuration)
+        maxScanDuration = duration;
+
+    // Schedule the next scan one interval after this one was due. If the scan is late by more than a whole interval,
+    // schedule it relative to now instead of trying to catch up with a burst of scans.
+    nextScan += interval;
+    if ((int32_t)(time_us_32() - nextScan) >= 0)
+        nextScan = time_us_32() + interval;
+
+    // Use the slack time until the next scan for the background tasks, then wait for the next scan.
+    runTasks();
+    wait();
+}
+
+void SCAN_FUNC(SchedulerHandler::runTasks)()
+{
+    // Go through all tasks once in round-robin order, starting with the one after the last task that ran. This way,
+    // every task gets the chance to run first and a long task can not starve the ones after it.
+    uint8_t first = nextTask;
+    for (uint8_t i = 0; i < taskCount; i++)
+    {
+        Task &task = tasks[(first + i) % taskCount];
+
+        // Only start the task if it fits into the slack time left until the next scan, otherwise defer it. Long-running tasks
+        // never fit, which is why they are started anyway.
+        uint32_t start = time_us_32();
+        if (task.budget != LONG_RUNNING_TASK && (int32_t)(nextScan - start) < (int32_t)task.budget)
+        {
+            task.deferrals++;
+            continue;
+        }
+
+        // Run the task and account it's duration.
+        task.function();
+        uint32_t duration = time_us_32() - start;
+        task.runs++;
+        if (task.budget != LONG_RUNNING_TASK && duration > task.budget)
+            task.overruns++;
+        if (duration > task.maxDuration)
+            task.maxDuration = duration;
+
+        nextTask = (first + i + 1) % taskCount;
+    }
+}
+
+void SCAN_FUNC(SchedulerHandler::wait)()
+{
+    // If the next scan is not due yet, wait for it. While idle, the core sleeps in a low power state.
+    int32_t remaining = nextScan - time_us_32();
+    if (remaining <= 0)
+        return;
+
+    if (PowerHandler.idle)
+    {
+        LoopPhase previous = WatchdogHandler.enter(LoopPhase::Sleeping);
+        sleep_us(remaining);
+        WatchdogHandler.enter(previous);
+    }
+    else
+        while ((int32_t)(nextScan - time_us_32()) > 0)
+            tight_loop_contents();
+}
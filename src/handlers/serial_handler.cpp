@@ -1,7 +1,19 @@
 #include <Arduino.h>
 #include "handlers/serial_handler.hpp"
 #include "handlers/keypad_handler.hpp"
+#include "handlers/led_handler.hpp"
+#include "handlers/power_handler.hpp"
+#include "handlers/watchdog_handler.hpp"
+#include "handlers/latency_handler.hpp"
+#include "handlers/rapid_trigger_checker.hpp"
+#include "handlers/benchmark_handler.hpp"
+#include "handlers/trace_handler.hpp"
+#include "handlers/boot_handler.hpp"
+#include "handlers/warm_restart_handler.hpp"
+#include "handlers/scheduler_handler.hpp"
 #include "helpers/string_helper.hpp"
+#include "helpers/hid_helper.hpp"
+#include "helpers/latency_probe.hpp"
 #include "definitions.hpp"
 extern "C"
 {
@@ -9,14 +21,17 @@ extern "C"
 }
 
 // Define a handy macro for printing with a newline character at the end.
-#define print(fmt, ...) Serial.printf(fmt "\n", __VA_ARGS__)
+#define print(fmt, ...) output->printf(fmt "\n", __VA_ARGS__)
 
 // Define two more handy macros for interpreting the serial input.
 #define isEqual(str1, str2) strcmp(str1, str2) == 0
 #define isTrue(str) isEqual(str, "1") || isEqual(str, "true")
 
-void SerialHandler::handleSerialInput(char *input)
+void SerialHandler::handleSerialInput(char *input, Print &output)
 {
+    // Remember the interface the command was received on, so the response is written back to it.
+    this->output = &output;
+
     // Make the input buffer lowercase for further parsing.
     StringHelper::toLower(input);
 
@@ -24,6 +39,33 @@ void SerialHandler::handleSerialInput(char *input)
     char command[SERIAL_INPUT_BUFFER_SIZE];
     StringHelper::getArgumentAt(input, ' ', 0, command);
 
+    // Commands that do not write the configuration are handled right away.
+    if (!isConfigCommand(command))
+    {
+        handleCommand(command, input);
+        return;
+    }
+
+    // Remember the configuration before handling the command, so it can be restored if the command left it in an invalid state.
+    // This guarantees that no malformed input from the host can ever corrupt the configuration. The copy is kept
+    // static to not put it on the stack next to the large parsing buffers.
+    static Configuration previous;
+    previous = ConfigController.config;
+    handleCommand(command, input);
+    if (!ConfigController.isValid(ConfigController.config))
+        ConfigController.config = previous;
+}
+
+bool SerialHandler::isConfigCommand(const char *command)
+{
+    // The key and macro commands and the global commands setting a configuration value write the configuration directly.
+    // Importing a configuration is not one of them, since it is validated as a whole before it replaces the configuration.
+    return strstr(command, "hkey") == command || strstr(command, "dkey") == command || strstr(command, "macro") == command ||
+           isEqual(command, "name") || isEqual(command, "led") || isEqual(command, "idle");
+}
+
+void SerialHandler::handleCommand(const char *command, char *input)
+{
     // Get a pointer pointing to the start of all parameters for the command.
     char *parameters = input + strlen(command);
 
@@ -44,14 +86,44 @@ void SerialHandler::handleSerialInput(char *input)
         save();
     else if (isEqual(command, "get"))
         get();
+    else if (isEqual(command, "export"))
+        exportConfig();
+    else if (isEqual(command, "import"))
+        importConfig(arg0);
     else if (isEqual(command, "name"))
         name(parameters);
     else if (isEqual(command, "out"))
         out(isEqual(arg0, ""), isTrue(arg0));
+    else if (isEqual(command, "led"))
+        led(isEqual(arg0, ""), atoi(arg0));
+    else if (isEqual(command, "idle"))
+        idle(isEqual(arg0, ""), atoi(arg0));
+    else if (isEqual(command, "watchdog"))
+        watchdog();
+    else if (isEqual(command, "tasks"))
+        tasks();
+    else if (isEqual(command, "serialout"))
+        serialout();
+    else if (isEqual(command, "boottime"))
+        boottime();
+    else if (isEqual(command, "latency"))
+        latency(isEqual(arg0, "reset"));
+#ifdef TRACE_RECORDER
+    else if (isEqual(command, "trace"))
+        trace(parameters);
+#endif
 #ifdef DEV
     else if (isEqual(command, "echo"))
         echo(parameters);
 #endif
+#ifdef RAPID_TRIGGER_CHECK
+    else if (isEqual(command, "rtcheck"))
+        rtcheck(isEqual(arg0, "reset"));
+#endif
+#ifdef BENCHMARK
+    else if (isEqual(command, "bench"))
+        BenchmarkHandler.run(*output);
+#endif
 
     // Handle hall effect key specific commands by checking if the command starts with "hkey".
     if (strstr(command, "hkey") == command)
@@ -70,8 +142,8 @@ void SerialHandler::handleSerialInput(char *input)
         if (strlen(keyStr) > 4)
         {
             // Get the index and check if it's in the valid range.
-            uint8_t keyIndex = atoi(keyStr + 4) - 1;
-            if (keyIndex >= HE_KEYS)
+            uint8_t keyIndex;
+            if (!StringHelper::parseIndex(keyStr + 4, HE_KEYS, &keyIndex))
                 return;
 
             // Replace the array with that single key.
@@ -99,8 +171,22 @@ void SerialHandler::handleSerialInput(char *input)
                 hkey_uh(key, atoi(arg0));
             else if (isEqual(setting, "char"))
                 key_char(key, strlen(arg0) == 1 ? (int)arg0[0] : atoi(arg0) /* Allow for either the ASCII character or integer */);
+            else if (isEqual(setting, "code"))
+                key_code(key, strtoul(arg0, nullptr, 0));
+            else if (isEqual(setting, "mod"))
+                key_mod(key, strtoul(arg0, nullptr, 0));
             else if (isEqual(setting, "hid"))
                 key_hid(key, isTrue(arg0));
+            else if (isEqual(setting, "macro"))
+                key_macro(key, atoi(arg0));
+#ifdef LATENCY_PROBE_PIN
+            else if (isEqual(setting, "probe"))
+                key_probe(key, isTrue(arg0));
+#endif
+            else if (isEqual(setting, "color"))
+                hkey_color(key, strtoul(arg0, nullptr, 16));
+            else if (isEqual(setting, "smaexp"))
+                hkey_smaexp(key, atoi(arg0));
         }
     }
 
@@ -121,10 +207,8 @@ void SerialHandler::handleSerialInput(char *input)
         if (strlen(keyStr) > 4)
         {
             // Get the index and check if it's in the valid range.
-            uint8_t keyIndex = atoi(keyStr + 4) - 1;
-#pragma GCC diagnostic ignored "-Wtype-limits"
-            if (keyIndex >= DIGITAL_KEYS)
-#pragma GCC diagnostic pop
+            uint8_t keyIndex;
+            if (!StringHelper::parseIndex(keyStr + 4, DIGITAL_KEYS, &keyIndex))
                 return;
 
             // Replace the array with that single digital key.
@@ -140,28 +224,118 @@ void SerialHandler::handleSerialInput(char *input)
             // Handle the settings.
             if (isEqual(setting, "char"))
                 key_char(key, strlen(arg0) == 1 ? (int)arg0[0] : atoi(arg0) /* Allow for either the ASCII character or integer */);
+            else if (isEqual(setting, "code"))
+                key_code(key, strtoul(arg0, nullptr, 0));
+            else if (isEqual(setting, "mod"))
+                key_mod(key, strtoul(arg0, nullptr, 0));
             else if (isEqual(setting, "hid"))
                 key_hid(key, isTrue(arg0));
+            else if (isEqual(setting, "macro"))
+                key_macro(key, atoi(arg0));
+#ifdef LATENCY_PROBE_PIN
+            else if (isEqual(setting, "probe"))
+                key_probe(key, isTrue(arg0));
+#endif
+        }
+    }
+
+    // Handle macro specific commands by checking if the command starts with "macro".
+    if (strstr(command, "macro") == command)
+    {
+        // Split the command into the macro string and the setting name.
+        char macroStr[SERIAL_INPUT_BUFFER_SIZE];
+        char setting[SERIAL_INPUT_BUFFER_SIZE];
+        StringHelper::getArgumentAt(command, '.', 0, macroStr);
+        StringHelper::getArgumentAt(command, '.', 1, setting);
+
+        // Macros are always targetted individually, so get the index and check if it's in the valid range.
+        uint8_t macroIndex;
+        if (!StringHelper::parseIndex(macroStr + 5, MACROS, &macroIndex))
+            return;
+
+        // Handle the settings.
+        if (isEqual(setting, "steps"))
+            macro_steps(ConfigController.config.macros[macroIndex], parameters);
+    }
+}
+
+void SerialHandler::printHEKeyOutput(const KeypadSnapshot &snapshot)
+{
+    // Print out the index of every key, the last sensor reading and the last mapped value in the output format.
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        print("OUT hkey%d=%d %d", i + 1, snapshot.heKeys[i].sensorValue, snapshot.heKeys[i].mappedValue);
+}
+
+void SerialHandler::update()
+{
+    // Only read the bytes that already arrived and never wait for more, so a host device sending a line slowly or without a
+    // terminator can not block the loop. The line is collected across runs and at most one line is handled per run, so a
+    // burst of commands is spread across the slack time of multiple scans instead of blocking the loop until all are handled.
+    // While a trace dump is written, no commands are handled, since their responses would end up in the middle of the dump.
+#ifdef TRACE_RECORDER
+    if (TraceHandler.isDumping())
+        return;
+#endif
+    int available = Serial.available();
+    while (available-- > 0)
+    {
+        char c = Serial.read();
+        if (c != '\n')
+        {
+            // Append the character to the line, leaving space for the null terminator. If the line does not fit into the
+            // buffer, it is dropped as a whole once the newline character arrives instead of handling a truncated command.
+            if (inputLength < SERIAL_INPUT_BUFFER_SIZE - 1)
+                input[inputLength++] = c;
+            else
+                inputOverflow = true;
+            continue;
+        }
+
+        // Terminate the line and start collecting the next one, then handle the line if it was complete.
+        input[inputLength] = '\0';
+        bool overflow = inputOverflow;
+        inputLength = 0;
+        inputOverflow = false;
+        if (!overflow)
+        {
+            handleSerialInput(input);
+            return;
         }
     }
 }
 
-void SerialHandler::printHEKeyOutput(const HEKey &key)
+void SerialHandler::stream()
 {
-    // Print out the index of the key, the last sensor reading and the last mapped value in the output format.
-    print("OUT hkey%d=%d %d", key.index + 1, KeypadHandler.heKeyStates[key.index].lastSensorValue, KeypadHandler.heKeyStates[key.index].lastMappedValue);
+    // If the output mode is enabled, output the raw and mapped values of the latest scan, unless they were output already.
+    if (!KeypadHandler.outputMode)
+        return;
+
+    KeypadSnapshot snapshot;
+    KeypadHandler.getSnapshot(snapshot);
+    if (snapshot.scan == lastStreamedScan)
+        return;
+
+    // Write the values to the interface the output mode was enabled on. On the serial interface, they are written into the
+    // telemetry channel, which is buffered separately from the command responses so neither of them delays the other one.
+    output = streamOutput;
+    SerialOutputHandler.setChannel(OutputChannel::Telemetry);
+    printHEKeyOutput(snapshot);
+    SerialOutputHandler.setChannel(OutputChannel::Response);
+    output->flush();
+    lastStreamedScan = snapshot.scan;
 }
 
 void SerialHandler::boot()
 {
-    // Set the RP2040 into bootloader mode.
+    // Write the latest state of the keys into the warm restart snapshot, then set the RP2040 into bootloader mode.
+    WarmRestartHandler.save();
     reset_usb_boot(0, 0);
 }
 
 void SerialHandler::save()
 {
-    // Save the configuration managed by the config controller.
-    ConfigController.saveConfig();
+    // Request a save of the configuration managed by the config controller, which is done in the background.
+    ConfigController.requestSave();
 }
 
 void SerialHandler::get()
@@ -171,11 +345,17 @@ void SerialHandler::get()
     print("GET hkeys=%d", HE_KEYS);
     print("GET dkeys=%d", DIGITAL_KEYS);
     print("GET name=%s", ConfigController.config.name);
+    print("GET led=%d", ConfigController.config.ledBrightness);
+    print("GET idle=%d", ConfigController.config.idleTimeout);
     print("GET htol=%d", HYSTERESIS_TOLERANCE);
     print("GET rtol=%d", RAPID_TRIGGER_TOLERANCE);
     print("GET trdt=%d", TRAVEL_DISTANCE_IN_0_01MM);
     print("GET ares=%d", ANALOG_RESOLUTION);
 
+    // Get a consistent snapshot of the key states for the calibration values.
+    KeypadSnapshot snapshot;
+    KeypadHandler.getSnapshot(snapshot);
+
     // Output all hall effect key-specific settings.
     for (const HEKey &key : ConfigController.config.heKeys)
     {
@@ -187,47 +367,262 @@ void SerialHandler::get()
         print("GET hkey%d.lh=%d", key.index + 1, key.lowerHysteresis);
         print("GET hkey%d.uh=%d", key.index + 1, key.upperHysteresis);
         print("GET hkey%d.char=%d", key.index + 1, key.keyChar);
-        print("GET hkey%d.rest=%d", key.index + 1, KeypadHandler.heKeyStates[key.index].restPosition);
-        print("GET hkey%d.down=%d", key.index + 1, KeypadHandler.heKeyStates[key.index].downPosition);
+        print("GET hkey%d.code=%d", key.index + 1, key.keyCode);
+        print("GET hkey%d.mod=%d", key.index + 1, key.keyModifiers);
+        print("GET hkey%d.rest=%d", key.index + 1, snapshot.heKeys[key.index].restPosition);
+        print("GET hkey%d.down=%d", key.index + 1, snapshot.heKeys[key.index].downPosition);
         print("GET hkey%d.hid=%d", key.index + 1, key.hidEnabled);
+        print("GET hkey%d.macro=%d", key.index + 1, key.macro);
+        print("GET hkey%d.color=%06lx", key.index + 1, key.color);
+        print("GET hkey%d.smaexp=%d", key.index + 1, key.smaExponent);
     }
 
     // Output all digital key-specific settings.
     for (const DigitalKey &key : ConfigController.config.digitalKeys)
     {
         print("GET dkey%d.char=%d", key.index + 1, key.keyChar);
+        print("GET dkey%d.code=%d", key.index + 1, key.keyCode);
+        print("GET dkey%d.mod=%d", key.index + 1, key.keyModifiers);
         print("GET dkey%d.hid=%d", key.index + 1, key.hidEnabled);
+        print("GET dkey%d.macro=%d", key.index + 1, key.macro);
+    }
+
+    // Output all macros in the same format they are set with.
+    for (uint8_t i = 0; i < MACROS; i++)
+    {
+        char steps[MACRO_STEPS * 8 + 1];
+        formatMacroSteps(ConfigController.config.macros[i], steps);
+        print("GET macro%d.steps=%s", i + 1, steps);
     }
 
     // Print this line to signalize the end of printing the settings to the listener.
-    Serial.println("GET END");
+    output->println("GET END");
+}
+
+void SerialHandler::exportConfig()
+{
+    // Export the whole configuration as a checksummed blob and output it in the hex format.
+    static ConfigurationBlob blob;
+    static char hex[sizeof(ConfigurationBlob) * 2 + 1];
+    ConfigController.exportConfig(blob);
+    StringHelper::toHex(&blob, sizeof(blob), hex);
+    print("EXPORT %s", hex);
+}
+
+void SerialHandler::importConfig(const char *hex)
+{
+    // Parse the blob from the hex format and import it, replacing the whole configuration if it is intact and valid.
+    static ConfigurationBlob blob;
+    bool imported = StringHelper::fromHex(hex, &blob, sizeof(blob)) && ConfigController.importConfig(blob);
+    print("IMPORT %s", imported ? "ok" : "error");
 }
 
 void SerialHandler::name(char *name)
 {
-    // Get the length of the name and check if it's within the 1-128 characters boundary.
+    // Get the length of the name and check if it fits into the name buffer, including the null terminator.
     size_t length = strlen(name);
-    if (length >= 1 && length <= 128)
-        memcpy(ConfigController.config.name, name + '\0', length + 1);
+    if (length >= 1 && length < sizeof(ConfigController.config.name))
+        memcpy(ConfigController.config.name, name, length + 1);
 }
 
 void SerialHandler::out(bool single, bool state)
 {
     // If single is true, no argument was specified. In that case just output every key once.
     if (single)
-        for (const HEKey &key : ConfigController.config.heKeys)
-            printHEKeyOutput(key);
+    {
+        KeypadSnapshot snapshot;
+        KeypadHandler.getSnapshot(snapshot);
+        printHEKeyOutput(snapshot);
+    }
     else
-        // Otherwise, set the calibration mode field of the keypad handler to the specified state.
+    {
+        // Otherwise, set the calibration mode field of the keypad handler to the specified state and
+        // remember the interface the command was received on, so the values are streamed to it.
         KeypadHandler.outputMode = state;
+        streamOutput = output;
+    }
+}
+
+void SerialHandler::led(bool single, uint8_t brightness)
+{
+    // If single is true, no argument was specified. In that case output the statistics of the LEDs.
+    if (single)
+    {
+        print("LED publish=%lu", LEDHandler.lastPublishCycles);
+        print("LED publishmax=%lu", LEDHandler.maxPublishCycles);
+        print("LED frames=%lu", LEDHandler.frames);
+        print("LED skipped=%lu", LEDHandler.skippedFrames);
+        output->println("LED END");
+    }
+    else
+        // Otherwise, set the LED brightness config value to the specified state.
+        ConfigController.config.ledBrightness = brightness;
+}
+
+void SerialHandler::idle(bool single, uint16_t timeout)
+{
+    // If single is true, no argument was specified. In that case output the statistics of the idle mode.
+    if (single)
+    {
+        print("IDLE state=%d", PowerHandler.idle);
+        print("IDLE entries=%lu", PowerHandler.entries);
+        print("IDLE exits=%lu", PowerHandler.exits);
+        print("IDLE wake=%lu", PowerHandler.lastWakeLatency);
+        print("IDLE wakemax=%lu", PowerHandler.maxWakeLatency);
+        output->println("IDLE END");
+    }
+    else
+        // Otherwise, set the idle timeout config value to the specified state.
+        ConfigController.config.idleTimeout = timeout;
+}
+
+void SerialHandler::watchdog()
+{
+    // Output whether the last reset was caused by the watchdog and the stall that was ongoing at the time of the reset.
+    print("WATCHDOG reboot=%d", WatchdogHandler.causedReboot);
+    if (WatchdogHandler.hasPostMortem)
+        print("WATCHDOG stall=%lums %s %lu", WatchdogHandler.postMortem.gap, WatchdogHandler.getPhaseName(WatchdogHandler.postMortem.phase), WatchdogHandler.postMortem.uptime);
+
+    // Output the longest gaps between two completed scans, including the phase that took the longest and the time it ended at.
+    for (uint8_t i = 0; i < WATCHDOG_STALL_RECORDS; i++)
+    {
+        const StallRecord &record = WatchdogHandler.records[i];
+        print("WATCHDOG gap%d=%luus %s %lu", i + 1, record.gap, WatchdogHandler.getPhaseName(record.phase), record.uptime);
+    }
+
+    output->println("WATCHDOG END");
+}
+
+void SerialHandler::tasks()
+{
+    // Output the statistics of the scan, which is run at a fixed rate with the highest priority.
+    print("TASKS scan=%lu %lu %luus %dus", SchedulerHandler.scans, SchedulerHandler.lateScans, SchedulerHandler.maxScanDuration, SCAN_INTERVAL_US);
+
+    // Output the statistics of all background tasks run in the slack time between the scans.
+    for (uint8_t i = 0; i < SchedulerHandler.taskCount; i++)
+    {
+        const Task &task = SchedulerHandler.tasks[i];
+        print("TASKS %s=%lu %lu %lu %luus %luus", task.name, task.runs, task.overruns, task.deferrals, task.maxDuration, task.budget);
+    }
+
+    output->println("TASKS END");
+}
+
+void SerialHandler::serialout()
+{
+    // Output the statistics of the buffers of all channels of the serial output.
+    const char *channels[] = {"telemetry", "response"};
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        const OutputQueue &queue = SerialOutputHandler.queues[i];
+        print("SERIALOUT %s=%lu %lu %u %u %u", channels[i], queue.sent, queue.dropped, queue.queued, queue.maxQueued, queue.size);
+    }
+
+    output->println("SERIALOUT END");
+}
+
+void SerialHandler::boottime()
+{
+    // Output the boot metrics, which are the times the boot phases were reached at since the reset of the RP2040.
+    for (uint8_t i = 0; i < BOOT_PHASES; i++)
+        print("BOOTTIME %s=%luus", BootHandler.getPhaseName((BootPhase)i), BootHandler.times[i]);
+
+    // Output whether the state of the keys was restored from the warm restart snapshot.
+    print("BOOTTIME warm=%d", WarmRestartHandler.restored);
+
+    output->println("BOOTTIME END");
+}
+
+void SerialHandler::latency(bool reset)
+{
+    // If reset is true, clear the histograms instead of outputting them.
+    if (reset)
+    {
+        LatencyHandler.reset();
+        return;
+    }
+
+    // Output the histogram of every key, with the counts of all log2 buckets separated by whitespaces.
+    for (uint8_t i = 0; i < LATENCY_KEYS; i++)
+    {
+        char buckets[LATENCY_BUCKETS * 11 + 1];
+        char *position = buckets;
+        for (uint8_t j = 0; j < LATENCY_BUCKETS; j++)
+            position += sprintf(position, j == 0 ? "%lu" : " %lu", LatencyHandler.histograms[i][j]);
+
+        if (i < HE_KEYS)
+            print("LATENCY hkey%d=%s", i + 1, buckets);
+        else
+            print("LATENCY dkey%d=%s", i - HE_KEYS + 1, buckets);
+    }
+
+    output->println("LATENCY END");
 }
 
+#ifdef TRACE_RECORDER
+void SerialHandler::trace(char *parameters)
+{
+    // Parse the action and the pre-trigger depth, post-trigger depth and trigger value.
+    char action[SERIAL_INPUT_BUFFER_SIZE];
+    char arg[SERIAL_INPUT_BUFFER_SIZE];
+    StringHelper::getArgumentAt(parameters, ' ', 0, action);
+    StringHelper::getArgumentAt(parameters, ' ', 1, arg);
+    uint16_t preFrames = atoi(arg);
+    StringHelper::getArgumentAt(parameters, ' ', 2, arg);
+    uint16_t postFrames = atoi(arg);
+    StringHelper::getArgumentAt(parameters, ' ', 3, arg);
+    uint16_t value = atoi(arg);
+
+    // Arm the trace recorder with the specified trigger, fire the manual trigger or dump the recorded trace.
+    if (isEqual(action, "manual"))
+        TraceHandler.arm(TraceTrigger::Manual, preFrames, postFrames, 0);
+    else if (isEqual(action, "press"))
+        TraceHandler.arm(TraceTrigger::OnPress, preFrames, postFrames, 0);
+    else if (isEqual(action, "value"))
+        TraceHandler.arm(TraceTrigger::OnValue, preFrames, postFrames, value);
+    else if (isEqual(action, "fire"))
+        TraceHandler.fire();
+    // The dump is always written to the serial interface, since it is continued in the background after the command.
+    else if (isEqual(action, "dump"))
+    {
+        if (!TraceHandler.dump())
+            output->println("TRACE EMPTY");
+    }
+    // If no action was specified, output the state of the trace recorder.
+    else if (isEqual(action, ""))
+    {
+        const char *states[] = {"stopped", "armed", "triggered", "finished"};
+        print("TRACE state=%s", states[TraceHandler.state]);
+        print("TRACE frames=%d", TRACE_FRAMES);
+    }
+}
+#endif
+
 void SerialHandler::echo(char *input)
 {
     // Output the same input. This command is used for debugging purposes and only available in said environemnts.
-    Serial.println(input);
+    output->println(input);
 }
 
+#ifdef RAPID_TRIGGER_CHECK
+void SerialHandler::rtcheck(bool reset)
+{
+    // If reset is true, clear the violation counters instead of outputting them.
+    if (reset)
+    {
+        RapidTriggerChecker.reset();
+        return;
+    }
+
+    // Output the amount of unexpected presses, unexpected releases and stuck key states of every hall effect key.
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        print("RTCHECK hkey%d=%lu %lu %lu", i + 1, RapidTriggerChecker.violations[i][RapidTriggerViolation::UnexpectedPress],
+              RapidTriggerChecker.violations[i][RapidTriggerViolation::UnexpectedRelease], RapidTriggerChecker.violations[i][RapidTriggerViolation::StuckKey]);
+
+    output->println("RTCHECK END");
+}
+#endif
+
 void SerialHandler::hkey_rt(HEKey &key, bool state)
 {
     // Set the rapid trigger config value to the specified state.
@@ -274,10 +669,51 @@ void SerialHandler::hkey_uh(HEKey &key, uint16_t value)
         key.upperHysteresis = value;
 }
 
+void SerialHandler::hkey_color(HEKey &key, uint32_t color)
+{
+    // Set the color config value to the specified state, cutting off anything above the 24 color bits.
+    key.color = color & 0xFFFFFF;
+}
+
+void SerialHandler::hkey_smaexp(HEKey &key, uint8_t exponent)
+{
+    // Check if the specified exponent does not exceed the size of the filter buffers.
+    if (exponent <= SMA_FILTER_MAX_SAMPLE_EXPONENT)
+        // Set the SMA filter sample exponent config value to the specified state. The keypad handler
+        // applies it to the filter of the key on the next scan.
+        key.smaExponent = exponent;
+}
+
 void SerialHandler::key_char(Key &key, uint8_t keyChar)
 {
-    // Set the key config value of the specified key to the specified state.
+    // Set the key config value of the specified key to the specified state and compile it into the HID usage
+    // code and modifiers, so the keypad handler does not have to convert the key char on every press.
     key.keyChar = keyChar;
+    HIDHelper::getUsage(keyChar, &key.keyCode, &key.keyModifiers);
+}
+
+void SerialHandler::key_code(Key &key, uint32_t code)
+{
+    // Check if the specified usage code fits into the HID report.
+    if (code > 0xFF)
+        return;
+
+    // Set the HID usage code of the specified key to the specified value. The key char is reset, since the
+    // key no longer corresponds to it.
+    key.keyCode = code;
+    key.keyChar = 0;
+}
+
+void SerialHandler::key_mod(Key &key, uint32_t modifiers)
+{
+    // Check if the specified modifiers fit into the modifier byte of the HID report.
+    if (modifiers > 0xFF)
+        return;
+
+    // Set the HID modifier bits of the specified key to the specified value. The key char is reset, since the
+    // key no longer corresponds to it.
+    key.keyModifiers = modifiers;
+    key.keyChar = 0;
 }
 
 void SerialHandler::key_hid(Key &key, bool state)
@@ -285,3 +721,75 @@ void SerialHandler::key_hid(Key &key, bool state)
     // Set the hid config value of the specified key to the specified state.
     key.hidEnabled = state;
 }
+
+void SerialHandler::key_macro(Key &key, uint8_t macro)
+{
+    // Check if the specified macro exists or is 0, which unassigns the macro from the key.
+    if (macro <= MACROS)
+        // Set the macro config value of the specified key to the specified state.
+        key.macro = macro;
+}
+
+#ifdef LATENCY_PROBE_PIN
+void SerialHandler::key_probe(Key &key, bool state)
+{
+    // Select or deselect the key for toggling the latency probe pin. This is not part of the configuration
+    // since the probe is only used for measurements and not meant to be persisted.
+    uint32_t mask = 1UL << LatencyHandler::getKey(key);
+    LatencyProbe::keys = state ? LatencyProbe::keys | mask : LatencyProbe::keys & ~mask;
+}
+#endif
+
+void SerialHandler::macro_steps(Macro &macro, char *steps)
+{
+    // Parse the steps into a separate macro first, so an invalid step does not leave a partially written macro behind.
+    Macro parsed;
+    char step[SERIAL_INPUT_BUFFER_SIZE];
+    for (StringHelper::getArgumentAt(steps, ' ', 0, step); step[0] != '\0'; StringHelper::getArgumentAt(steps, ' ', parsed.length, step))
+    {
+        // Check whether the macro still has space for another step.
+        if (parsed.length >= MACRO_STEPS)
+            return;
+
+        // Parse the step, consisting of the type (p = press, r = release, d = delay) and the value.
+        // Press and release steps allow for either the ASCII character or integer, just like the char setting.
+        // Values out of range of a key char or a 16-bit delay are rejected instead of wrapping around.
+        MacroStep &parsedStep = parsed.steps[parsed.length++];
+        const char *value = step + 1;
+        uint32_t number;
+        if (step[0] == 'p' || step[0] == 'r')
+        {
+            parsedStep.type = step[0] == 'p' ? MacroStepType::Press : MacroStepType::Release;
+            if (strlen(value) == 1)
+                number = (uint8_t)value[0];
+            else if (!StringHelper::parseNumber(value, UINT8_MAX, &number))
+                return;
+            parsedStep.value = number;
+        }
+        else if (step[0] == 'd')
+        {
+            parsedStep.type = MacroStepType::Delay;
+            if (!StringHelper::parseNumber(value, UINT16_MAX, &number))
+                return;
+            parsedStep.value = number;
+        }
+        else
+            return;
+    }
+
+    // Replace the macro with the parsed one. Specifying no steps at all clears the macro.
+    macro = parsed;
+}
+
+void SerialHandler::formatMacroSteps(const Macro &macro, char *buffer)
+{
+    // Format the steps in the same format they are set with, separated by whitespaces.
+    // Key chars are written as their ASCII number to not break the format on whitespace characters.
+    buffer[0] = '\0';
+    for (uint8_t i = 0; i < macro.length && i < MACRO_STEPS; i++)
+    {
+        const MacroStep &step = macro.steps[i];
+        char type = step.type == MacroStepType::Press ? 'p' : step.type == MacroStepType::Release ? 'r' : 'd';
+        buffer += sprintf(buffer, i == 0 ? "%c%d" : " %c%d", type, step.value);
+    }
+}
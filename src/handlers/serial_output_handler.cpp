@@ -0,0 +1,165 @@
+#include <Arduino.h>
+#include "handlers/serial_output_handler.hpp"
+
+void SerialOutputHandler::update()
+{
+    // Send as much of the buffered data as the host device currently accepts.
+    drain();
+}
+
+void SerialOutputHandler::setChannel(OutputChannel channel)
+{
+    this->channel = channel;
+}
+
+void SerialOutputHandler::beginBlock()
+{
+    // Write the following data into the channel as it is, without collecting it into lines. The block is kept together
+    // with the lines before and after it, since the channel is not switched until all of it was sent.
+    queues[channel].block = true;
+    queues[channel].blockPending = true;
+}
+
+void SerialOutputHandler::endBlock()
+{
+    // Collect the following data into lines again. The block is finished right away if all of it was sent already.
+    queues[channel].block = false;
+    if (queues[channel].queued == 0)
+        queues[channel].blockPending = false;
+}
+
+size_t SerialOutputHandler::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t SerialOutputHandler::write(const uint8_t *data, size_t size)
+{
+    // Write binary blocks into the ring buffer as they are. The writer of the block is responsible for only writing as much
+    // as the buffer has space for, which is why nothing is waited for and data that does not fit is dropped.
+    OutputQueue &queue = queues[channel];
+    if (queue.block)
+    {
+        if ((size_t)(queue.size - queue.queued) < size)
+        {
+            queue.dropped += size;
+            return 0;
+        }
+
+        commit(queue, data, size);
+        return size;
+    }
+
+    // Collect the text into the line buffer and write every finished line into the ring buffer as a whole, so the host device
+    // never receives partial lines. Lines longer than the line buffer are dropped as a whole once they end.
+    for (size_t i = 0; i < size; i++)
+    {
+        if (queue.lineLength < queue.lineSize)
+            queue.line[queue.lineLength] = data[i];
+        else
+            queue.lineOverflow = true;
+        queue.lineLength++;
+
+        if (data[i] != '\n')
+            continue;
+
+        if (!queue.lineOverflow && reserve(queue, queue.lineLength))
+            commit(queue, queue.line, queue.lineLength);
+        else
+            queue.dropped += queue.lineLength;
+
+        queue.lineLength = 0;
+        queue.lineOverflow = false;
+    }
+
+    return size;
+}
+
+int SerialOutputHandler::availableForWrite()
+{
+    // Return the space left in the buffer of the channel that is currently being written.
+    return queues[channel].size - queues[channel].queued;
+}
+
+void SerialOutputHandler::flush()
+{
+    // Send as much of the buffered data as possible without waiting for the host device.
+    drain();
+}
+
+void SerialOutputHandler::commit(OutputQueue &queue, const uint8_t *data, size_t size)
+{
+    // Copy the data into the ring buffer of the channel, wrapping around at the end of it.
+    for (size_t i = 0; i < size; i++)
+    {
+        queue.buffer[queue.head] = data[i];
+        queue.head = (queue.head + 1) % queue.size;
+    }
+
+    queue.queued += size;
+    if (queue.queued > queue.maxQueued)
+        queue.maxQueued = queue.queued;
+}
+
+bool SerialOutputHandler::reserve(OutputQueue &queue, size_t size)
+{
+    // Check whether the data fits into the buffer right away or after sending what the host device accepts right now.
+    // The host device is never waited for, if the data does not fit either way, it is dropped by the caller.
+    if ((size_t)(queue.size - queue.queued) >= size)
+        return true;
+
+    drain();
+    return (size_t)(queue.size - queue.queued) >= size;
+}
+
+size_t SerialOutputHandler::drain()
+{
+    // Send the buffered data in contiguous parts, since it may wrap around the end of the ring buffers. Only write as much as
+    // the USB CDC interface accepts right now, since writing more would wait for the host device.
+    OutputQueue &telemetry = queues[OutputChannel::Telemetry];
+    OutputQueue &responses = queues[OutputChannel::Response];
+    size_t sent = 0;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        int available = Serial.availableForWrite();
+        if (available <= 0)
+            break;
+
+        // Continue the channel that is in the middle of a line or binary block, since the channels may only be switched outside
+        // of them. Otherwise, send the command responses first.
+        bool response = !(telemetry.lineStarted || telemetry.blockPending) &&
+                        (responses.lineStarted || responses.blockPending || responses.queued > 0);
+        OutputQueue &queue = response ? responses : telemetry;
+        if (queue.queued == 0)
+            break;
+
+        // Send the data up to the end of the ring buffer, but at most as much as the interface accepts.
+        size_t size = queue.queued;
+        if (size > (size_t)(queue.size - queue.tail))
+            size = queue.size - queue.tail;
+        if (size > (size_t)available)
+            size = available;
+
+        size_t written = Serial.write(queue.buffer + queue.tail, size);
+        if (written == 0)
+            break;
+
+        // Remember whether the channel was sent up to the end of a line, which is the only point the other channel may continue at.
+        // Inside of binary blocks this is meaningless, since the block is tracked as a whole.
+        queue.lineStarted = queue.buffer[(queue.tail + written - 1) % queue.size] != '\n';
+
+        queue.tail = (queue.tail + written) % queue.size;
+        queue.queued -= written;
+        queue.sent += written;
+        sent += written;
+
+        // A binary block is finished once it was ended and everything written into the channel until then was sent.
+        if (queue.blockPending && !queue.block && queue.queued == 0)
+        {
+            queue.blockPending = false;
+            queue.lineStarted = false;
+        }
+    }
+
+    return sent;
+}
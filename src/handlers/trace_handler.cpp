@@ -0,0 +1,195 @@
+#ifdef TRACE_RECORDER
+#include <Arduino.h>
+#include "handlers/trace_handler.hpp"
+#include "handlers/serial_output_handler.hpp"
+#include "helpers/crc32.hpp"
+extern "C"
+{
+#include "pico/time.h"
+}
+
+// The version of the dump format, incremented on every change of the header or frame layout.
+#define TRACE_DUMP_VERSION 1
+
+// The header of a dump, followed by the frames and a CRC-32 of the header and frames. All values are little-endian.
+struct __attribute__((packed)) TraceDumpHeader
+{
+    char magic[4];
+    uint8_t version;
+    uint8_t keys;
+    uint16_t frameSize;
+    uint16_t frameCount;
+    uint16_t triggerFrame;
+    uint8_t trigger;
+    uint8_t reserved;
+    uint16_t triggerValue;
+};
+
+void TraceHandler::arm(TraceTrigger trigger, uint16_t preFrames, uint16_t postFrames, uint16_t value)
+{
+    // Make sure the pre- and post-trigger depth fit into the buffer together. The post-trigger depth includes the trigger frame.
+    if (postFrames == 0 || postFrames > TRACE_FRAMES || preFrames > TRACE_FRAMES - postFrames)
+        return;
+
+    // Stop the recording while the settings are changed, then start recording the pre-trigger frames.
+    state = TraceState::Stopped;
+    this->trigger = trigger;
+    this->preFrames = preFrames;
+    this->postFrames = postFrames;
+    triggerValue = value;
+    head = 0;
+    recorded = 0;
+    manualFired = false;
+    memset(wasPressed, 0, sizeof(wasPressed));
+    wasPressedValid = false;
+    state = TraceState::Armed;
+}
+
+void TraceHandler::fire()
+{
+    // Request the manual trigger, which is picked up on the next recorded scan.
+    manualFired = true;
+}
+
+void SCAN_FUNC(TraceHandler::record)(const HEKeyState *states)
+{
+    // Only record while armed or triggered.
+    if (state != TraceState::Armed && state != TraceState::Triggered)
+        return;
+
+    // Take over the pressed states of the keys on the first scan of a recording, so keys already pressed down when the
+    // recorder was armed are neither flagged as pressed in this scan nor fire the press trigger.
+    if (!wasPressedValid)
+    {
+        for (uint8_t i = 0; i < HE_KEYS; i++)
+            wasPressed[i] = states[i].pressed;
+        wasPressedValid = true;
+    }
+
+    // Write the values of all hall effect keys into the next frame of the ring buffer.
+    TraceFrame &frame = frames[head];
+    frame.time = time_us_32();
+    bool pressed = false;
+    bool belowValue = false;
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        const HEKeyState &keyState = states[i];
+        frame.samples[i] = {keyState.lastRawValue, keyState.lastSensorValue, keyState.lastMappedValue,
+                            (uint8_t)(keyState.pressed | keyState.inRapidTriggerZone << 1 | (keyState.pressed && !wasPressed[i]) << 2 | (!keyState.pressed && wasPressed[i]) << 3), 0};
+
+        // Check the conditions of the triggers and remember the pressed state for detecting presses in the next scan.
+        pressed |= keyState.pressed && !wasPressed[i];
+        belowValue |= keyState.lastMappedValue <= triggerValue;
+        wasPressed[i] = keyState.pressed;
+    }
+
+    uint16_t index = head;
+    head = (head + 1) % TRACE_FRAMES;
+    if (recorded < TRACE_FRAMES)
+        recorded++;
+
+    // While armed, check whether the trigger fired and start the post-trigger recording if so.
+    if (state == TraceState::Armed)
+    {
+        if (manualFired || (trigger == TraceTrigger::OnPress && pressed) || (trigger == TraceTrigger::OnValue && belowValue))
+        {
+            triggerFrame = index;
+            remaining = postFrames;
+            state = TraceState::Triggered;
+        }
+        // Keep at most the pre-trigger depth before the trigger, so the post-trigger frames never overwrite them.
+        else if (recorded > preFrames)
+            recorded = preFrames;
+    }
+
+    // Finish the recording once all post-trigger frames have been recorded.
+    if (state == TraceState::Triggered && --remaining == 0)
+        state = TraceState::Finished;
+}
+
+bool TraceHandler::dump()
+{
+    // Only dump finished recordings, since the buffer is still being written otherwise.
+    if (state != TraceState::Finished || dumping)
+        return false;
+
+    // Announce the binary dump with it's total size in bytes so the host knows how much to read.
+    SerialOutputHandler.printf("TRACE DUMP %u\n", sizeof(TraceDumpHeader) + recorded * sizeof(TraceFrame) + sizeof(uint32_t));
+
+    // Start writing the dump as a binary block, which is continued in the background as far as the host device reads it
+    // instead of writing all of it at once, which would neither fit into the buffer of the serial output nor the slack time.
+    SerialOutputHandler.beginBlock();
+    dumpFirst = (head + TRACE_FRAMES - recorded) % TRACE_FRAMES;
+    dumpIndex = 0;
+    dumpProgress = time_us_32();
+    dumping = true;
+    return true;
+}
+
+void TraceHandler::update()
+{
+    // Only continue the dump while one is running.
+    if (!dumping)
+        return;
+
+    // Write the next parts of the dump, but only as far as they fit into the buffer of the serial output, so no part is dropped.
+    // Space for the line ending the dump is always kept free, so the end of the dump is never dropped, even if it is aborted.
+    // The amount of parts per run is limited, since the checksum of each frame has to fit into the slack time too.
+    int available = SerialOutputHandler.availableForWrite() - (int)sizeof("TRACE ABORTED\r\n");
+    for (uint8_t i = 0; i < TRACE_DUMP_FRAMES_PER_RUN; i++)
+    {
+        // Write the header first, containing everything needed to parse and replay the frames.
+        if (dumpIndex == 0)
+        {
+            TraceDumpHeader header = {{'M', 'P', 'T', 'R'}, TRACE_DUMP_VERSION, HE_KEYS, sizeof(TraceFrame), recorded,
+                                      (uint16_t)((triggerFrame + TRACE_FRAMES - dumpFirst) % TRACE_FRAMES), trigger, 0, triggerValue};
+            if (available < (int)sizeof(header))
+                break;
+
+            SerialOutputHandler.write((const uint8_t *)&header, sizeof(header));
+            available -= sizeof(header);
+            dumpCrc = CRC32::compute(&header, sizeof(header));
+        }
+        // Write the frames in chronological order, starting at the oldest one in the ring buffer.
+        else if (dumpIndex <= recorded)
+        {
+            const TraceFrame &frame = frames[(dumpFirst + dumpIndex - 1) % TRACE_FRAMES];
+            if (available < (int)sizeof(frame))
+                break;
+
+            SerialOutputHandler.write((const uint8_t *)&frame, sizeof(frame));
+            available -= sizeof(frame);
+            dumpCrc = CRC32::update(dumpCrc, &frame, sizeof(frame));
+        }
+        // Write the checksum, followed by a line signalizing the end of the dump to the listener.
+        else
+        {
+            if (available < (int)sizeof(dumpCrc))
+                break;
+
+            SerialOutputHandler.write((const uint8_t *)&dumpCrc, sizeof(dumpCrc));
+            SerialOutputHandler.endBlock();
+            SerialOutputHandler.println("TRACE END");
+            dumping = false;
+            return;
+        }
+
+        dumpIndex++;
+        dumpProgress = time_us_32();
+    }
+
+    // Abort the dump if the host device did not read anything for too long, so a host device that stopped reading does not
+    // block the command responses forever. The host device notices the abort by the line following the incomplete data.
+    if (time_us_32() - dumpProgress >= TRACE_DUMP_TIMEOUT_US)
+    {
+        SerialOutputHandler.endBlock();
+        SerialOutputHandler.println("TRACE ABORTED");
+        dumping = false;
+    }
+}
+
+bool TraceHandler::isDumping()
+{
+    return dumping;
+}
+#endif
@@ -0,0 +1,68 @@
+#include <Arduino.h>
+#include "handlers/warm_restart_handler.hpp"
+#include "handlers/keypad_handler.hpp"
+#include "helpers/crc32.hpp"
+extern "C"
+{
+#include "pico/time.h"
+}
+
+// The magic number identifying a written snapshot ("WARM").
+#define WARM_RESTART_MAGIC 0x5741524D
+
+// The snapshot is placed into RAM that is not zeroed on bootup, so it survives soft resets. After a power loss,
+// the contents are random and the snapshot is rejected by the checksum.
+static WarmRestartSnapshot __uninitialized_ram(warmRestartSnapshot);
+
+void WarmRestartHandler::restore()
+{
+    // Only restore the snapshot if it was written by a firmware with the same keys and is intact.
+    WarmRestartSnapshot &snapshot = warmRestartSnapshot;
+    if (snapshot.magic != WARM_RESTART_MAGIC || snapshot.keys != HE_KEYS || snapshot.analogResolution != ANALOG_RESOLUTION || snapshot.crc != checksum())
+        return;
+
+    // Restore the calibration of all keys and seed their filters with the last filtered value, so the
+    // keys are usable on the very first scan without having to be calibrated again.
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        HEKeyState &state = KeypadHandler.heKeyStates[i];
+        state.restPosition = snapshot.heKeys[i].restPosition;
+        state.downPosition = snapshot.heKeys[i].downPosition;
+        state.filter(snapshot.heKeys[i].filteredValue);
+    }
+
+    // Invalidate the snapshot, so it is only restored once and never from a run before the previous one.
+    snapshot.magic = 0;
+    restored = true;
+}
+
+void SCAN_FUNC(WarmRestartHandler::update)()
+{
+    // Write the snapshot if the interval has passed since it was last written.
+    if (time_us_32() - lastSave >= WARM_RESTART_INTERVAL_MS * 1000)
+        save();
+}
+
+void WarmRestartHandler::save()
+{
+    // Copy the runtime state of all keys that have valid values into the snapshot.
+    WarmRestartSnapshot &snapshot = warmRestartSnapshot;
+    snapshot.magic = WARM_RESTART_MAGIC;
+    snapshot.keys = HE_KEYS;
+    snapshot.analogResolution = ANALOG_RESOLUTION;
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        const HEKeyState &state = KeypadHandler.heKeyStates[i];
+        snapshot.heKeys[i] = {state.restPosition, state.downPosition, state.lastSensorValue};
+    }
+
+    // Calculate the checksum over the written snapshot.
+    snapshot.crc = checksum();
+    lastSave = time_us_32();
+}
+
+uint32_t WarmRestartHandler::checksum() const
+{
+    // Calculate the CRC32 checksum over all fields of the snapshot before the checksum itself.
+    return CRC32::compute(&warmRestartSnapshot, offsetof(WarmRestartSnapshot, crc));
+}
@@ -0,0 +1,121 @@
+#include <Arduino.h>
+#include "handlers/watchdog_handler.hpp"
+extern "C"
+{
+#include "hardware/watchdog.h"
+}
+
+// Magic number in the first scratch register marking the other scratch registers as a valid stall record.
+// Only the scratch registers 0-3 are used since 4-7 are used by the SDK and bootrom for rebooting.
+#define STALL_RECORD_MAGIC 0x57A11ED0
+
+void WatchdogHandler::begin()
+{
+    // Check whether the last reset was caused by the watchdog and read the stall record from the scratch
+    // registers if one was written before the reset. Clear it afterwards so it is not read again on the next reset.
+    causedReboot = watchdog_caused_reboot();
+    if (watchdog_hw->scratch[0] == STALL_RECORD_MAGIC)
+    {
+        hasPostMortem = true;
+        postMortem.phase = (LoopPhase)watchdog_hw->scratch[1];
+        postMortem.gap = watchdog_hw->scratch[2];
+        postMortem.uptime = watchdog_hw->scratch[3];
+        watchdog_hw->scratch[0] = 0;
+    }
+
+    // Start the stall check timer with twice the frequency of the stall threshold and enable the hardware watchdog.
+    // The watchdog is paused while debugging so breakpoints do not reset the RP2040.
+    lastScan = time_us_32();
+    add_repeating_timer_ms(-WATCHDOG_STALL_THRESHOLD_MS / 2, check, this, &timer);
+    watchdog_enable(WATCHDOG_TIMEOUT_MS, true);
+}
+
+LoopPhase SCAN_FUNC(WatchdogHandler::enter)(LoopPhase next)
+{
+    // Remember the phase that is left if it took the longest since the last completed scan.
+    uint32_t now = time_us_32();
+    if (now - phaseStart >= culpritDuration)
+    {
+        culprit = phase;
+        culpritDuration = now - phaseStart;
+    }
+
+    // Enter the next phase and return the previous one so it can be restored afterwards.
+    LoopPhase previous = phase;
+    phase = next;
+    phaseStart = now;
+    return previous;
+}
+
+void SCAN_FUNC(WatchdogHandler::scanCompleted)()
+{
+    // Leave the current phase, accounting it's duration for the gap.
+    enter(LoopPhase::Other);
+
+    // Calculate the gap since the last completed scan and insert it into the records if it's one of the longest.
+    uint32_t now = time_us_32();
+    uint32_t gap = now - lastScan;
+    for (uint8_t i = 0; i < WATCHDOG_STALL_RECORDS; i++)
+    {
+        if (gap <= records[i].gap)
+            continue;
+
+        // Move the shorter records down by one, dropping the shortest one, and insert the gap.
+        for (uint8_t j = WATCHDOG_STALL_RECORDS - 1; j > i; j--)
+            records[j] = records[j - 1];
+        records[i] = {gap, culprit, (uint32_t)millis()};
+        break;
+    }
+
+    // Start the next gap and feed the hardware watchdog.
+    lastScan = now;
+    culpritDuration = 0;
+    watchdog_update();
+
+    // If a stall has been written into the scratch registers, it is over now and has to be cleared.
+    if (stallWritten)
+    {
+        watchdog_hw->scratch[0] = 0;
+        stallWritten = false;
+    }
+}
+
+bool WatchdogHandler::check(repeating_timer_t *timer)
+{
+    WatchdogHandler *handler = (WatchdogHandler *)timer->user_data;
+
+    // If no scan has been completed for longer than the stall threshold, write the ongoing stall into the scratch registers.
+    // It is updated on every check until the stall is over or the watchdog resets the RP2040, keeping the last state of it.
+    uint32_t gap = time_us_32() - handler->lastScan;
+    if (gap >= WATCHDOG_STALL_THRESHOLD_MS * 1000)
+    {
+        watchdog_hw->scratch[1] = handler->phase;
+        watchdog_hw->scratch[2] = gap / 1000;
+        watchdog_hw->scratch[3] = millis();
+        watchdog_hw->scratch[0] = STALL_RECORD_MAGIC;
+        handler->stallWritten = true;
+    }
+
+    // Return true to keep the repeating timer running.
+    return true;
+}
+
+const char *WatchdogHandler::getPhaseName(LoopPhase phase)
+{
+    // Return a lowercase name of the phase for the serial output.
+    switch (phase)
+    {
+    case LoopPhase::Scanning:
+        return "scanning";
+    case LoopPhase::Reporting:
+        return "reporting";
+    case LoopPhase::Sleeping:
+        return "sleeping";
+    case LoopPhase::SerialInput:
+        return "serial";
+    case LoopPhase::ConfigSave:
+        return "save";
+    default:
+        return "other";
+    }
+}
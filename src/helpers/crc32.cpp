@@ -0,0 +1,25 @@
+#include <Arduino.h>
+#include "helpers/crc32.hpp"
+
+uint32_t CRC32::update(uint32_t crc, const void *data, size_t length)
+{
+    // Calculate the standard CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320) bit by bit. A lookup table would be
+    // faster but cost 1KB of memory, while checksums are only calculated outside of the keypad scan anyway.
+    // The crc is inverted on the way in and out, allowing to continue a previous calculation with the returned value.
+    const uint8_t *bytes = (const uint8_t *)data;
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= bytes[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+
+    return ~crc;
+}
+
+uint32_t CRC32::compute(const void *data, size_t length)
+{
+    // Calculate the checksum starting from the initial value.
+    return update(0, data, length);
+}
@@ -0,0 +1,46 @@
+#include <Arduino.h>
+#include "helpers/hid_helper.hpp"
+
+// The HID usage codes of the ASCII characters on the US keyboard layout. The highest bit is set on characters
+// that are typed with the shift key held down. Characters without a key on the layout are mapped to 0.
+static const uint8_t asciiMap[128] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // NUL-BEL
+    0x2A, 0x2B, 0x28, 0x00, 0x00, 0x28, 0x00, 0x00, // BS, TAB, LF, VT, FF, CR, SO, SI
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // DLE-ETB
+    0x00, 0x00, 0x00, 0x29, 0x00, 0x00, 0x00, 0x00, // CAN, EM, SUB, ESC, FS-US
+    0x2C, 0x9E, 0xB4, 0xA0, 0xA1, 0xA2, 0xA4, 0x34, // space ! " # $ % & '
+    0xA6, 0xA7, 0xA5, 0xAE, 0x36, 0x2D, 0x37, 0x38, // ( ) * + , - . /
+    0x27, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, // 0-7
+    0x25, 0x26, 0xB3, 0x33, 0xB6, 0x2E, 0xB7, 0xB8, // 8 9 : ; < = > ?
+    0x9F, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, // @ A-G
+    0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90, 0x91, 0x92, // H-O
+    0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, // P-W
+    0x9B, 0x9C, 0x9D, 0x2F, 0x31, 0x30, 0xA3, 0xAD, // X Y Z [ \ ] ^ _
+    0x35, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, // ` a-g
+    0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, // h-o
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, // p-w
+    0x1B, 0x1C, 0x1D, 0xAF, 0xB1, 0xB0, 0xB5, 0x00  // x y z { | } ~ DEL
+};
+
+void HIDHelper::getUsage(uint8_t keyChar, uint8_t *code, uint8_t *modifiers)
+{
+    // Key chars from 136 upwards are non-printing keys, whose usage code is the key char minus 136. This is the same
+    // encoding the Arduino keyboard library uses for the arrow keys, function keys etc. (e.g. KEY_F1 = 0xC2)
+    if (keyChar >= 136)
+    {
+        *code = keyChar - 136;
+        *modifiers = 0;
+    }
+    // Key chars from 128 to 135 are the modifier keys, each of which sets the corresponding bit in the modifier byte.
+    else if (keyChar >= 128)
+    {
+        *code = 0;
+        *modifiers = 1 << (keyChar - 128);
+    }
+    // Otherwise, look up the ASCII character in the US keyboard layout and hold the shift key if the character needs it.
+    else
+    {
+        *code = asciiMap[keyChar] & 0x7F;
+        *modifiers = asciiMap[keyChar] & 0x80 ? HID_MODIFIER_LEFT_SHIFT : 0;
+    }
+}
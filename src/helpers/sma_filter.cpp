@@ -1,9 +1,19 @@
 #include <Arduino.h>
 #include "helpers/sma_filter.hpp"
+#include "definitions.hpp"
 
 // On the call operator the next value is given into the filter, with the new average being returned.
-uint16_t SMAFilter::operator()(uint16_t value)
+uint16_t SCAN_FUNC(SMAFilter::operator())(uint16_t value)
 {
+    // If no value has been passed into the filter yet, seed the whole buffer with the first value instead of
+    // the zeroes it starts with. This way, the filter outputs valid values starting with the very first sample.
+    if (!initialized)
+    {
+        seed(value);
+        initialized = true;
+        return value;
+    }
+
     // Calculate the new sum by removing the oldest element and adding the new one.
     sum = sum - buffer[index] + value;
 
@@ -13,10 +23,28 @@ uint16_t SMAFilter::operator()(uint16_t value)
     // Move the index by 1 or restart at 0 if the end is reached.
     index = (index + 1) % samples;
 
-    // If the index is 0 here (meaning the circular index just reset), set the fully initialized state to true.
-    if(index == 0)
-        initialized = true;
-
     // Divide the number by the amount of samples using bitshifting and return it.
     return sum >> samplesExponent;
 }
+
+void SCAN_FUNC(SMAFilter::setSamplesExponent)(uint8_t exponent)
+{
+    // Remember the current average before changing the amount of samples.
+    uint16_t average = sum >> samplesExponent;
+    samplesExponent = exponent;
+    samples = 1 << exponent;
+
+    // If the filter has been seeded already, reseed the whole new window with the current average, so the filter
+    // continues with the same output instead of having to be filled again. Otherwise, the next value seeds it.
+    if (initialized)
+        seed(average);
+}
+
+void SCAN_FUNC(SMAFilter::seed)(uint16_t value)
+{
+    // Fill the whole window with the value and calculate the matching sum.
+    for (uint8_t i = 0; i < samples; i++)
+        buffer[i] = value;
+    sum = (uint32_t)value << samplesExponent;
+    index = 0;
+}
@@ -34,17 +34,18 @@ void StringHelper::getArgumentAt(const char* input, char delimiter, uint8_t inde
 
 void StringHelper::toLower(char *input)
 {
-    // Go through all characters and replace them with their lowercase version.
-    for (size_t i = 0; i < strlen(input); i++)
-        input[i] = tolower(input[i]);
+    // Go through all characters and replace them with their lowercase version. The characters are passed as unsigned
+    // since tolower is undefined for negative values, and the length is not re-evaluated on every iteration.
+    for (; *input; input++)
+        *input = tolower((unsigned char)*input);
 }
 
 void StringHelper::replace(char *input, char target, char replacement)
 {
     // Go through all characters and replace it if it matches the target character.
-    for (size_t i = 0; i < strlen(input); i++)
-        if (input[i] == target)
-            input[i] = replacement;
+    for (; *input; input++)
+        if (*input == target)
+            *input = replacement;
 }
 
 void StringHelper::makeSafename(char *str)
@@ -53,10 +54,11 @@ void StringHelper::makeSafename(char *str)
     // Our two pointers src and str will progress differently, src is used to iterate over
     // the input char array while str points to the next character to be written for our output.
     const char *src = str;
+    const char *start = str;
 
     // Skip all characters by moving the src pointer forward until the character array reached the end or
     // a non-whitespace character is encountered. This ignores all leading whitespaces of the character array.
-    while (*src && isspace(*src))
+    while (*src && isspace((unsigned char)*src))
         src++;
 
     // Go through the input char array with our separate pointer until it reached the zero terminator.
@@ -64,7 +66,7 @@ void StringHelper::makeSafename(char *str)
     {
         // If the current character is not a whitespace or a whitespace and different from the previous character,
         // put the character into the position our str pointer is currently pointing at, replacing the character array on the fly.
-        if (!isspace(*src) || *src != *(src - 1))
+        if (!isspace((unsigned char)*src) || *src != *(src - 1))
         {
             *str = *src;
 
@@ -77,7 +79,8 @@ void StringHelper::makeSafename(char *str)
     }
 
     // Remove a whitespace at the end if one exists. Only one at most can exist there as we compacted consecutive whitespaces before.
-    if (isspace(*(str - 1)))
+    // If nothing was written (empty or whitespace-only input), there is no previous character to look at.
+    if (str > start && isspace((unsigned char)*(str - 1)))
         str--;
 
     // Append the null terminator that finishes the string at that position. This is important since we are modifying the input
@@ -85,3 +88,89 @@ void StringHelper::makeSafename(char *str)
     // e.g. "  hello  world  " turns "hello worldrld  " so we place a zero terminator after the "world" word.
     *str = '\0';
 }
+
+bool StringHelper::parseIndex(const char *input, uint8_t count, uint8_t *index)
+{
+    // Parse the one-based index, only allowing digits and no more than 3 of them to not overflow.
+    // Unlike atoi, this does not silently turn invalid input into an index or wrap around on large numbers.
+    size_t length = strlen(input);
+    if (length == 0 || length > 3)
+        return false;
+
+    uint16_t value = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (!isdigit((unsigned char)input[i]))
+            return false;
+
+        value = value * 10 + input[i] - '0';
+    }
+
+    // Check whether the index is within the 1-count boundary and convert it to a zero-based one.
+    if (value < 1 || value > count)
+        return false;
+
+    *index = value - 1;
+    return true;
+}
+
+bool StringHelper::parseNumber(const char *input, uint32_t max, uint32_t *value)
+{
+    // Parse the unsigned number, only allowing digits and values up to the maximum. Unlike atoi, this does not silently
+    // turn invalid input into a number or wrap around on values out of range.
+    if (input[0] == '\0')
+        return false;
+
+    uint32_t number = 0;
+    for (const char *c = input; *c != '\0'; c++)
+    {
+        if (!isdigit((unsigned char)*c))
+            return false;
+
+        number = number * 10 + *c - '0';
+        if (number > max)
+            return false;
+    }
+
+    *value = number;
+    return true;
+}
+
+void StringHelper::toHex(const void *data, size_t length, char *output)
+{
+    // Write every byte as two lowercase hex digits and terminate the output. The output buffer has to be
+    // at least twice the length of the data plus one byte for the null terminator.
+    const char *digits = "0123456789abcdef";
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < length; i++)
+    {
+        *output++ = digits[bytes[i] >> 4];
+        *output++ = digits[bytes[i] & 0x0F];
+    }
+    *output = '\0';
+}
+
+bool StringHelper::fromHex(const char *input, void *data, size_t length)
+{
+    // Check whether the input contains exactly two hex digits per byte of the data.
+    if (strlen(input) != length * 2)
+        return false;
+
+    // Parse every pair of hex digits into a byte, rejecting any character that is not a hex digit.
+    uint8_t *bytes = (uint8_t *)data;
+    for (size_t i = 0; i < length * 2; i++)
+    {
+        char c = tolower((unsigned char)input[i]);
+        uint8_t nibble;
+        if (c >= '0' && c <= '9')
+            nibble = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            nibble = c - 'a' + 10;
+        else
+            return false;
+
+        bytes[i / 2] = i % 2 == 0 ? nibble << 4 : bytes[i / 2] | nibble;
+    }
+
+    return true;
+}
@@ -3,22 +3,60 @@
 #include <Keyboard.h>
 #include "config/configuration_controller.hpp"
 #include "handlers/serial_handler.hpp"
+#include "handlers/serial_output_handler.hpp"
 #include "handlers/keypad_handler.hpp"
+#include "handlers/macro_handler.hpp"
+#include "handlers/led_handler.hpp"
+#include "handlers/power_handler.hpp"
+#include "handlers/watchdog_handler.hpp"
+#include "handlers/boot_handler.hpp"
+#include "handlers/warm_restart_handler.hpp"
+#include "handlers/scheduler_handler.hpp"
+#include "handlers/trace_handler.hpp"
+#include "helpers/latency_probe.hpp"
 #include "definitions.hpp"
+extern "C"
+{
+#include "pico/time.h"
+#include "hardware/adc.h"
+}
+
+// Forward declarations of the keypad scan and the background tasks run by the scheduler.
+void scan();
+void handleSerialInput();
+void streamOutput();
+void sendSerialOutput();
+void saveConfig();
+void updateWarmRestart();
+#ifdef TRACE_RECORDER
+void continueTraceDump();
+#endif
 
 void setup()
 {
-    // Initialize the EEPROM with 1024 bytes and load the configuration from it.
-    EEPROM.begin(1024);
-    ConfigController.loadConfig();
+    BootHandler.mark(BootPhase::Setup);
 
-    // Initialize the serial and HID interface.
+    // Initialize the serial and HID interface first, so the enumeration by the host device runs in the background
+    // while the rest of the firmware is initialized and the first scans warm up the calibration. The keyboard library
+    // only registers the HID interface, the reports are built and submitted by the report handler.
     Serial.begin(115200);
     Keyboard.begin();
     Keyboard.setAutoReport(false);
+    BootHandler.mark(BootPhase::UsbStarted);
 
-    // Set the amount of bits for the ADC to the defined one for a better resolution on the analog readings.
-    analogReadResolution(ANALOG_RESOLUTION);
+    // Initialize the EEPROM with the size of the persistent configuration and load the configuration from it.
+    EEPROM.begin(sizeof(PersistentConfiguration));
+    ConfigController.loadConfig();
+    BootHandler.mark(BootPhase::ConfigLoaded);
+
+    // Restore the calibration and filters of the hall effect keys if the keypad was soft reset.
+    WarmRestartHandler.restore();
+
+    // Initialize the ADC and the pins of the hall effect keys. The keypad handler reads the ADC directly instead of
+    // using analogRead(), scaling the readings to the ANALOG_RESOLUTION definition on it's own.
+    adc_init();
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        adc_gpio_init(HE_PIN(i));
 
     // Allows to boot into UF2 bootloader mode by pressing the reset button twice.
     rp2040.enableDoubleResetBootloader();
@@ -26,25 +64,92 @@ void setup()
     // Set digital pins to support pullup
     for(int i = 0; i < DIGITAL_KEYS; i++)
         pinMode(i, INPUT_PULLUP);
+
+    // Initialize the latency probe pin. (only if enabled via the LATENCY_PROBE_PIN definition)
+    LatencyProbe::begin();
+
+    // Start the timer playing back macros triggered by keys.
+    MacroHandler.begin();
+
+    // Start the PIO state machine and timer driving the LEDs.
+    LEDHandler.begin();
+    BootHandler.mark(BootPhase::HardwareReady);
+
+    // Set up the scheduler with the keypad scan and the background tasks, run in the time between the scans. The budgets are the
+    // time in microseconds each invocation is expected to take at most, which has to fit into the slack time left after a scan.
+    // Saving the configuration commits the EEPROM to the flash memory, which takes milliseconds and can never fit into the slack
+    // time, which is why it runs as a long-running task, delaying the scans while a save is done.
+    SchedulerHandler.begin(scan);
+    SchedulerHandler.addTask("serial", handleSerialInput, 50);
+    SchedulerHandler.addTask("stream", streamOutput, 50);
+    SchedulerHandler.addTask("serialout", sendSerialOutput, 50);
+    SchedulerHandler.addTask("save", saveConfig, LONG_RUNNING_TASK);
+    SchedulerHandler.addTask("warmrestart", updateWarmRestart, 25);
+#ifdef TRACE_RECORDER
+    SchedulerHandler.addTask("tracedump", continueTraceDump, 50);
+#endif
+
+    // Start the watchdog last, since it has to be fed by the loop from this point on.
+    WatchdogHandler.begin();
+    BootHandler.mark(BootPhase::SetupDone);
 }
 
-void loop()
+void SCAN_FUNC(loop)()
 {
+    // Run the scheduler, which runs the keypad scan at a fixed rate and the background tasks in the time in between.
+    SchedulerHandler.run();
+}
+
+void SCAN_FUNC(scan)()
+{
+    // Remember the start of the scan for the wake up latency.
+    uint32_t scanStart = time_us_32();
+
     // Run the keypad handler checks to handle the actual keypad functionality.
+    WatchdogHandler.enter(LoopPhase::Scanning);
     KeypadHandler.handle();
+    WatchdogHandler.scanCompleted();
+
+    // Update the idle state, which throttles the scan rate and clock if no key has been touched for a while.
+    PowerHandler.update(KeypadHandler.active, scanStart);
+}
+
+void handleSerialInput()
+{
+    // Handle incoming serial data, at most one command per run.
+    WatchdogHandler.enter(LoopPhase::SerialInput);
+    SerialHandler.update();
+    WatchdogHandler.enter(LoopPhase::Other);
 }
 
-void serialEvent()
+void streamOutput()
 {
-    // Handle incoming serial data.
-    while(Serial.available() > 0)
-    {
-        // Read the incoming serial data until a newline into a buffer and terminate it with a null terminator.
-        char input[SERIAL_INPUT_BUFFER_SIZE];
-        const size_t inputLength = Serial.readBytesUntil('\n', input, SERIAL_INPUT_BUFFER_SIZE);
-        input[inputLength] = '\0';
+    // Output the values of the keys if the output mode is enabled.
+    SerialHandler.stream();
+}
+
+void sendSerialOutput()
+{
+    // Send the buffered serial output as far as the host device reads it.
+    SerialOutputHandler.update();
+}
 
-        // Pass the read input to the serial handler to handle it.
-        SerialHandler.handleSerialInput(input);
-    }
+void saveConfig()
+{
+    // Save the configuration if it was requested via the serial interface.
+    ConfigController.update();
+}
+
+void updateWarmRestart()
+{
+    // Write the runtime state of the keys into the warm restart snapshot, if it's time to.
+    WarmRestartHandler.update();
+}
+
+#ifdef TRACE_RECORDER
+void continueTraceDump()
+{
+    // Write the next parts of the trace dump into the serial output, if one is running.
+    TraceHandler.update();
 }
+#endif
@@ -0,0 +1,28 @@
+#include <Arduino.h>
+#include "handlers/benchmark_handler.hpp"
+#include "handlers/keypad_handler.hpp"
+#include "definitions.hpp"
+
+// Runs the benchmark of the hot-path components on the host, writing the results to the standard output. The host stubs
+// count nanoseconds instead of cycles, which is why the results are only comparable between runs on the same host.
+
+// A print target writing to the standard output.
+class StandardOutput : public Print
+{
+public:
+    size_t write(uint8_t c) override { return fwrite(&c, 1, 1, stdout); }
+    size_t write(const uint8_t *data, size_t size) override { return fwrite(data, 1, size, stdout); }
+    using Print::write;
+} standardOutput;
+
+int main()
+{
+    // Put the sensors of the hall effect keys at rest and run a few scans, so the filters are filled and calibrated.
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        HostStubs.adcValues[HE_PIN(i) - A0] = ANALOG_MAX_VALUE * 3 / 4;
+    for (uint16_t i = 0; i < 1024; i++)
+        KeypadHandler.handle();
+
+    BenchmarkHandler.run(standardOutput);
+    return 0;
+}
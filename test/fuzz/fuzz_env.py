@@ -0,0 +1,5 @@
+# Builds the native-fuzz environment with clang and links the fuzz target with libFuzzer and the sanitizers.
+Import("env")
+
+env.Replace(CC="clang", CXX="clang++", LINK="clang++")
+env.Append(LINKFLAGS=["-fsanitize=fuzzer,address,undefined"])
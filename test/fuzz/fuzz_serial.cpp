@@ -0,0 +1,112 @@
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/serial_handler.hpp"
+#include "handlers/trace_handler.hpp"
+#include "helpers/string_helper.hpp"
+#include "definitions.hpp"
+
+// Fuzzes the serial command handler and the string helpers it is built on with arbitrary input from the host device.
+// Built with libFuzzer via the native-fuzz environment. If FUZZ_REPLAY is defined, a main function replaying the files
+// passed as arguments is compiled in instead, which allows reproducing a finding with any compiler and sanitizer.
+
+// Runs the string helpers on a null-terminated line, checking the results are bounded by the line.
+void fuzzStringHelper(const char *line, size_t length)
+{
+    // Every argument is a part of the line, so it can never be longer than it.
+    static char argument[SERIAL_INPUT_BUFFER_SIZE];
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        StringHelper::getArgumentAt(line, i % 2 ? '.' : ' ', i, argument);
+        if (strlen(argument) > length)
+            abort();
+    }
+
+    // Parse the line as an index, as a number and as hex data of the size of a configuration blob, then write the data back as hex.
+    uint8_t index;
+    if (StringHelper::parseIndex(line, HE_KEYS, &index) && index >= HE_KEYS)
+        abort();
+
+    uint32_t number;
+    if (StringHelper::parseNumber(line, UINT16_MAX, &number) && number > UINT16_MAX)
+        abort();
+
+    static ConfigurationBlob blob;
+    static char hex[sizeof(ConfigurationBlob) * 2 + 1];
+    if (StringHelper::fromHex(line, &blob, sizeof(blob)))
+    {
+        StringHelper::toHex(&blob, sizeof(blob), hex);
+        if (strcasecmp(hex, line) != 0)
+            abort();
+    }
+
+    // The in-place helpers never make the line longer.
+    static char copy[SERIAL_INPUT_BUFFER_SIZE];
+    memcpy(copy, line, length + 1);
+    StringHelper::makeSafename(copy);
+    StringHelper::replace(copy, ' ', '_');
+    StringHelper::toLower(copy);
+    if (strlen(copy) > length)
+        abort();
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    // Start every input with the same configuration, so findings are reproducible from the input alone.
+    static Configuration initial = ConfigController.config;
+    ConfigController.config = initial;
+
+    // Run the string helpers on every line of the input that fits into the input buffer.
+    static char line[SERIAL_INPUT_BUFFER_SIZE];
+    size_t start = 0;
+    while (start < size)
+    {
+        const uint8_t *end = (const uint8_t *)memchr(data + start, '\n', size - start);
+        size_t length = (end ? end - data : size) - start;
+        if (length < SERIAL_INPUT_BUFFER_SIZE)
+        {
+            memcpy(line, data + start, length);
+            line[length] = '\0';
+            fuzzStringHelper(line, strlen(line));
+        }
+        start += length + 1;
+    }
+
+    // Receive the input via the serial interface, followed by a newline character so no partial line is left for the next
+    // input, and handle it like the serial tasks do, including a trace dump started by it. The command handler must never leave
+    // an invalid configuration.
+    Serial.input.assign((const char *)data, size);
+    Serial.input += '\n';
+    Serial.position = 0;
+    while (Serial.available())
+    {
+        SerialHandler.update();
+#ifdef TRACE_RECORDER
+        TraceHandler.update();
+#endif
+        SerialOutputHandler.update();
+        if (!ConfigController.isValid(ConfigController.config))
+            abort();
+    }
+
+    return 0;
+}
+
+#ifdef FUZZ_REPLAY
+int main(int argc, char **argv)
+{
+    // Replay every file passed as an argument as one input.
+    for (int i = 1; i < argc; i++)
+    {
+        FILE *file = fopen(argv[i], "rb");
+        if (!file)
+            continue;
+
+        static uint8_t data[1 << 16];
+        size_t size = fread(data, 1, sizeof(data), file);
+        fclose(file);
+        LLVMFuzzerTestOneInput(data, size);
+    }
+
+    return 0;
+}
+#endif
@@ -0,0 +1,135 @@
+#pragma once
+
+// Host stand-in for the subset of the arduino-pico core used by the firmware, so it can be compiled and tested natively.
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdlib>
+#include <cstdarg>
+#include <cstdio>
+#include <chrono>
+#include "host_stubs.hpp"
+#include "pico/stdlib.h"
+
+#define A0 26
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define LOW 0
+#define HIGH 1
+#define F_CPU 133000000
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+inline unsigned long micros() { return time_us_32(); }
+inline unsigned long millis() { return time_us_64() / 1000; }
+inline void delay(unsigned long ms) { HostStubs.micros += ms * 1000; }
+inline void delayMicroseconds(unsigned int us) { HostStubs.micros += us; }
+inline int analogRead(uint8_t pin) { return HostStubs.adcValues[pin - A0]; }
+inline void analogReadResolution(int) {}
+inline int digitalRead(uint8_t pin) { return !(HostStubs.gpioLow & (1UL << pin)); }
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline void pinMode(uint8_t, uint8_t) {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *data, size_t size)
+    {
+        size_t written = 0;
+        while (size--)
+            written += write(*data++);
+        return written;
+    }
+    size_t write(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buffer[2048];
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        if (length < 0)
+            return 0;
+        return write((const uint8_t *)buffer, (size_t)length < sizeof(buffer) ? length : sizeof(buffer) - 1);
+    }
+    size_t print(const char *text) { return write(text); }
+    size_t println(const char *text) { return write(text) + write("\r\n"); }
+    size_t println() { return write("\r\n"); }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long) {}
+
+    size_t readBytesUntil(char terminator, char *buffer, size_t length)
+    {
+        size_t count = 0;
+        while (count < length && available())
+        {
+            int c = read();
+            if (c == terminator)
+                break;
+            buffer[count++] = c;
+        }
+        return count;
+    }
+};
+
+// The USB CDC interface, which accepts as many bytes as the host window allows and never receives anything by itself.
+class SerialUSB : public Stream
+{
+public:
+    void begin(unsigned long) {}
+    operator bool() { return true; }
+    void ignoreFlowControl(bool = true) {}
+    int available() override { return input.size() - position; }
+    int read() override { return position < input.size() ? (uint8_t)input[position++] : -1; }
+    int peek() override { return position < input.size() ? (uint8_t)input[position] : -1; }
+    int availableForWrite() override { return HostStubs.serialWindow; }
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *data, size_t size) override
+    {
+        if ((int)size > HostStubs.serialWindow)
+            size = HostStubs.serialWindow;
+        if (HostStubs.captureSerial)
+            HostStubs.serialOutput.append((const char *)data, size);
+        return size;
+    }
+    using Print::write;
+
+    // The bytes sent by the host device that were not read yet.
+    std::string input;
+    size_t position = 0;
+};
+inline SerialUSB Serial;
+
+// The cycle counter counts the nanoseconds of the host instead, so the benchmark measures the real time spent on the host.
+class RP2040
+{
+public:
+    uint32_t getCycleCount() { return getCycleCount64(); }
+    uint64_t getCycleCount64() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+    uint32_t f_cpu() { return F_CPU; }
+    void enableDoubleResetBootloader() {}
+    void idleOtherCore() {}
+    void resumeOtherCore() {}
+    void reboot() {}
+};
+inline RP2040 rp2040;
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "host_stubs.hpp"
+
+// Host stand-in for the emulated EEPROM of the arduino-pico core, backed by the host stub memory.
+class EEPROMClass
+{
+public:
+    void begin(size_t) {}
+    bool commit() { return true; }
+    size_t length() { return sizeof(HostStubs.eeprom); }
+    uint8_t *getDataPtr() { return HostStubs.eeprom; }
+
+    template <typename T>
+    T &get(int address, T &value)
+    {
+        memcpy((void *)&value, HostStubs.eeprom + address, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    const T &put(int address, const T &value)
+    {
+        memcpy(HostStubs.eeprom + address, (const void *)&value, sizeof(T));
+        return value;
+    }
+};
+inline EEPROMClass EEPROM;
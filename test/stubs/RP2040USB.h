@@ -0,0 +1,7 @@
+#pragma once
+
+#include "pico/mutex.h"
+
+// Host stand-in for the USB helpers of the arduino-pico core.
+inline mutex_t __usb_mutex;
+inline int __USBGetKeyboardReportID() { return 1; }
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+#include "host_stubs.hpp"
+
+// Host stand-in for the ADC, returning the value of the selected input from the host stubs.
+inline uint32_t __adcInput = 0;
+inline void adc_init() {}
+inline void adc_gpio_init(uint32_t) {}
+inline void adc_select_input(uint32_t input) { __adcInput = input; }
+inline uint16_t adc_read() { return HostStubs.adcValues[__adcInput]; }
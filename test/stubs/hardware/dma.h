@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+// Host stand-in for the DMA of the RP2040. Transfers never run and channels are never busy.
+typedef unsigned int uint;
+struct dma_channel_config
+{
+    uint32_t ctrl;
+};
+enum dma_channel_transfer_size
+{
+    DMA_SIZE_8,
+    DMA_SIZE_16,
+    DMA_SIZE_32
+};
+
+inline int dma_claim_unused_channel(bool) { return 0; }
+inline dma_channel_config dma_channel_get_default_config(uint) { return {}; }
+inline void channel_config_set_transfer_data_size(dma_channel_config *, dma_channel_transfer_size) {}
+inline void channel_config_set_read_increment(dma_channel_config *, bool) {}
+inline void channel_config_set_write_increment(dma_channel_config *, bool) {}
+inline void channel_config_set_dreq(dma_channel_config *, uint) {}
+inline void dma_channel_configure(uint, const dma_channel_config *, volatile void *, const volatile void *, uint, bool) {}
+inline bool dma_channel_is_busy(uint) { return false; }
+inline void dma_channel_set_read_addr(uint, const volatile void *, bool) {}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+#include "host_stubs.hpp"
+
+inline void gpio_init(uint32_t) {}
+inline void gpio_set_dir(uint32_t, bool) {}
+inline void gpio_put(uint32_t, bool) {}
+inline void gpio_xor_mask(uint32_t) {}
+inline bool gpio_get(uint32_t pin) { return !(HostStubs.gpioLow & (1UL << pin)); }
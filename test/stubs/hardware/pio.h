@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+// Host stand-in for the PIO of the RP2040. Nothing is ever executed, the transmit FIFOs can be written without effect.
+typedef unsigned int uint;
+struct pio_hw_t
+{
+    volatile uint32_t txf[4];
+};
+typedef pio_hw_t *PIO;
+inline pio_hw_t __pio0, __pio1;
+inline PIO pio0 = &__pio0, pio1 = &__pio1;
+
+struct pio_program
+{
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+};
+struct pio_sm_config
+{
+    uint32_t clkdiv, execctrl, shiftctrl, pinctrl;
+};
+enum pio_fifo_join
+{
+    PIO_FIFO_JOIN_NONE,
+    PIO_FIFO_JOIN_TX,
+    PIO_FIFO_JOIN_RX
+};
+
+inline pio_sm_config pio_get_default_sm_config() { return {}; }
+inline void sm_config_set_wrap(pio_sm_config *, uint, uint) {}
+inline void sm_config_set_sideset(pio_sm_config *, uint, bool, bool) {}
+inline void sm_config_set_sideset_pins(pio_sm_config *, uint) {}
+inline void sm_config_set_out_shift(pio_sm_config *, bool, bool, uint) {}
+inline void sm_config_set_fifo_join(pio_sm_config *, pio_fifo_join) {}
+inline void pio_sm_set_clkdiv_int_frac(PIO, uint, uint16_t, uint8_t) {}
+inline int pio_claim_unused_sm(PIO, bool) { return 0; }
+inline uint pio_add_program(PIO, const pio_program *) { return 0; }
+inline void pio_gpio_init(PIO, uint) {}
+inline void pio_sm_set_consecutive_pindirs(PIO, uint, uint, uint, bool) {}
+inline void pio_sm_init(PIO, uint, uint, const pio_sm_config *) {}
+inline void pio_sm_set_enabled(PIO, uint, bool) {}
+inline uint pio_get_dreq(PIO, uint, bool) { return 0; }
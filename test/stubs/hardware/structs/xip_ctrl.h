@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+
+typedef struct
+{
+    volatile uint32_t ctrl, flush, stat, ctr_hit, ctr_acc;
+} xip_ctrl_hw_t;
+inline xip_ctrl_hw_t __xipCtrl;
+inline xip_ctrl_hw_t *xip_ctrl_hw = &__xipCtrl;
@@ -0,0 +1,4 @@
+#pragma once
+
+// Host stand-in for the memory barrier of the RP2040, which is a compiler barrier on the host.
+inline void __dmb() { __asm__ volatile("" ::: "memory"); }
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+struct watchdog_hw_t
+{
+    volatile uint32_t ctrl, load, reason, scratch[8], tick;
+};
+inline watchdog_hw_t __watchdog;
+inline watchdog_hw_t *watchdog_hw = &__watchdog;
+
+inline void watchdog_enable(uint32_t, bool) {}
+inline void watchdog_update() {}
+inline bool watchdog_caused_reboot() { return false; }
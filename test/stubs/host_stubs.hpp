@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// The state of the host stand-ins for the RP2040 hardware and the arduino-pico core, used by the native tests to feed the
+// firmware with sensor values and to observe what it reported. Only used in the native environment, never on the device.
+inline struct HostStubs
+{
+    // The microsecond timer, which advances by one on every read so waiting loops in the firmware always terminate.
+    uint64_t micros = 0;
+
+    // The values returned by the ADC for every input and the GPIO pins that are pulled low.
+    uint16_t adcValues[4] = {};
+    uint32_t gpioLow = 0;
+
+    // The amount of bytes the USB CDC interface accepts before it is full and all bytes written to it, if captured.
+    int serialWindow = 4096;
+    bool captureSerial = false;
+    std::string serialOutput;
+
+    // The contents of the last keyboard report and the amount of reports submitted.
+    uint8_t reportModifiers = 0;
+    uint8_t reportCodes[6] = {};
+    uint32_t reports = 0;
+
+    // The emulated EEPROM contents.
+    uint8_t eeprom[4096] = {};
+} HostStubs;
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <cstdint>
+
+inline void reset_usb_boot(uint32_t, uint32_t) {}
@@ -0,0 +1,6 @@
+#pragma once
+
+typedef struct
+{
+    int owner;
+} mutex_t;
@@ -0,0 +1,9 @@
+#pragma once
+
+// Host stand-in for the section attributes of the Pico SDK, which have no meaning on the host.
+#define __not_in_flash_func(name) name
+#define __time_critical_func(name) name
+#define __not_in_flash(group)
+#define __uninitialized_ram(name) name
+
+inline void tight_loop_contents() {}
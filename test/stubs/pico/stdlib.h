@@ -0,0 +1,5 @@
+#pragma once
+
+#include "pico/platform.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include "host_stubs.hpp"
+
+// Host stand-in for the timer of the Pico SDK. Repeating timers are remembered but never fired, the tests call them.
+struct repeating_timer
+{
+    int64_t delay_us;
+    void *user_data;
+    bool (*callback)(repeating_timer *);
+};
+typedef repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *);
+
+inline uint64_t time_us_64() { return ++HostStubs.micros; }
+inline uint32_t time_us_32() { return (uint32_t)time_us_64(); }
+inline void sleep_us(uint64_t us) { HostStubs.micros += us; }
+inline void busy_wait_us_32(uint32_t us) { HostStubs.micros += us; }
+
+inline bool add_repeating_timer_us(int64_t delay, repeating_timer_callback_t callback, void *data, repeating_timer_t *timer)
+{
+    *timer = {delay, data, callback};
+    return true;
+}
+
+inline bool add_repeating_timer_ms(int32_t delay, repeating_timer_callback_t callback, void *data, repeating_timer_t *timer)
+{
+    return add_repeating_timer_us(delay * 1000LL, callback, data, timer);
+}
+
+inline bool cancel_repeating_timer(repeating_timer_t *timer)
+{
+    timer->callback = nullptr;
+    return true;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include "host_stubs.hpp"
+
+// Host stand-in for the TinyUSB device API, recording the keyboard reports into the host stubs.
+inline bool tud_mounted() { return true; }
+inline bool tud_hid_ready() { return true; }
+inline bool tud_hid_keyboard_report(uint8_t, uint8_t modifiers, const uint8_t codes[6])
+{
+    HostStubs.reportModifiers = modifiers;
+    memcpy(HostStubs.reportCodes, codes, sizeof(HostStubs.reportCodes));
+    HostStubs.reports++;
+    return true;
+}
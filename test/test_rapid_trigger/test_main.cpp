@@ -0,0 +1,237 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <random>
+#include "handlers/keypad_handler.hpp"
+#include "handlers/rapid_trigger_checker.hpp"
+#include "definitions.hpp"
+
+// Gives the tests access to the private rapid trigger logic of the keypad handler.
+class KeypadTest
+{
+public:
+    static void check(const HEKey &key, uint16_t value) { KeypadHandler.checkHEKey(key, value); }
+};
+
+// The reference model of the actuation logic, written down from the description of rapid trigger in the README instead of
+// derived from the firmware code. It tracks the zone and the extreme value since the last actuation change, and the key is
+// pressed when entering the zone, then switches whenever it travelled by the sensitivity from that extreme.
+struct ReferenceKey
+{
+    bool pressed = false;
+    bool inZone = false;
+    uint16_t extreme = 0;
+
+    void step(const HEKey &key, uint16_t value)
+    {
+        // Without rapid trigger, the key is pressed below the lower and released above the upper hysteresis.
+        if (!key.rapidTrigger)
+        {
+            if (value <= key.lowerHysteresis)
+                pressed = true;
+            else if (value >= key.upperHysteresis)
+                pressed = false;
+            return;
+        }
+
+        // The zone is left above the upper hysteresis or, with continuous rapid trigger, only when fully released.
+        uint16_t exitPoint = key.continuousRapidTrigger ? TRAVEL_DISTANCE_IN_0_01MM - CONTINUOUS_RAPID_TRIGGER_THRESHOLD : key.upperHysteresis;
+        if (value >= exitPoint)
+            inZone = false;
+
+        // Entering the zone always presses the key. Inside of it, the key switches after travelling by the sensitivity from the
+        // extreme and outside of it, it is always released.
+        bool wasPressed = pressed;
+        if (!inZone && value <= key.lowerHysteresis)
+        {
+            inZone = true;
+            pressed = true;
+        }
+        else if (inZone && !pressed && extreme - value >= key.rapidTriggerDownSensitivity)
+            pressed = true;
+        else if (pressed && (!inZone || value - extreme >= key.rapidTriggerUpSensitivity))
+            pressed = false;
+
+        // The extreme starts over at the value the actuation changed at, otherwise it follows the direction of the key.
+        if (pressed != wasPressed || (pressed ? value < extreme : value > extreme))
+            extreme = value;
+    }
+};
+
+// Generates a random valid configuration of a hall effect key, with the same bounds the configuration controller checks.
+HEKey randomKey(std::mt19937 &random)
+{
+    HEKey key(0);
+    key.rapidTrigger = random() % 4 != 0;
+    key.continuousRapidTrigger = random() % 2;
+
+    // Prefer small sensitivities, since those are the ones used in practice and switch the most.
+    auto sensitivity = [&random]()
+    {
+        uint16_t max = random() % 2 ? 50 : TRAVEL_DISTANCE_IN_0_01MM;
+        return (uint16_t)(RAPID_TRIGGER_TOLERANCE + random() % (max - RAPID_TRIGGER_TOLERANCE + 1));
+    };
+    key.rapidTriggerUpSensitivity = sensitivity();
+    key.rapidTriggerDownSensitivity = sensitivity();
+
+    key.lowerHysteresis = random() % (TRAVEL_DISTANCE_IN_0_01MM - 2 * HYSTERESIS_TOLERANCE + 1);
+    key.upperHysteresis = key.lowerHysteresis + HYSTERESIS_TOLERANCE +
+                          random() % (TRAVEL_DISTANCE_IN_0_01MM - HYSTERESIS_TOLERANCE - key.lowerHysteresis - HYSTERESIS_TOLERANCE + 1);
+    return key;
+}
+
+// Generates a random trajectory of mapped values, made of segments of slow and fast movements, jitter around a point and jumps.
+void randomTrajectory(std::mt19937 &random, uint16_t *values, uint16_t length)
+{
+    int32_t value = TRAVEL_DISTANCE_IN_0_01MM;
+    uint16_t i = 0;
+    while (i < length)
+    {
+        uint8_t kind = random() % 4;
+        uint16_t segment = 1 + random() % 64;
+        int32_t speed = 1 + random() % 40;
+        int32_t direction = random() % 2 ? 1 : -1;
+        for (uint16_t j = 0; j < segment && i < length; j++, i++)
+        {
+            if (kind == 0)
+                value += direction * speed;
+            else if (kind == 1)
+                value += (int32_t)(random() % 7) - 3;
+            else if (kind == 2)
+                value = random() % (TRAVEL_DISTANCE_IN_0_01MM + 1);
+            else
+                value += direction * (int32_t)(random() % (speed + 1));
+
+            value = value < 0 ? 0 : value > TRAVEL_DISTANCE_IN_0_01MM ? TRAVEL_DISTANCE_IN_0_01MM : value;
+            values[i] = value;
+        }
+    }
+}
+
+// Runs a value through the firmware logic and the invariant checker like the keypad scan does.
+void checkValue(const HEKey &key, uint16_t value)
+{
+    HEKeyState &state = KeypadHandler.heKeyStates[key.index];
+    bool wasPressed = state.pressed;
+    uint16_t previousPeak = state.rapidTriggerPeak;
+    KeypadTest::check(key, value);
+    RapidTriggerChecker.check(key, wasPressed, previousPeak, state, value);
+}
+
+void setUp()
+{
+    // Start every test with a released key and no violations.
+    KeypadHandler.heKeyStates[0] = HEKeyState();
+    RapidTriggerChecker.reset();
+}
+
+void tearDown()
+{
+    // Fully release the key, so the keyboard report does not carry a pressed key into the next test.
+    checkValue(HEKey(0), TRAVEL_DISTANCE_IN_0_01MM);
+}
+
+void test_press_on_entering_zone()
+{
+    HEKey key(0);
+    checkValue(key, key.lowerHysteresis + 1);
+    TEST_ASSERT_FALSE(KeypadHandler.heKeyStates[0].pressed);
+    checkValue(key, key.lowerHysteresis);
+    TEST_ASSERT_TRUE(KeypadHandler.heKeyStates[0].pressed);
+}
+
+void test_release_and_press_by_sensitivity()
+{
+    // Press the key deep into the zone, then move it up by one less than and exactly by the up sensitivity.
+    HEKey key(0);
+    checkValue(key, 100);
+    checkValue(key, 100 + key.rapidTriggerUpSensitivity - 1);
+    TEST_ASSERT_TRUE(KeypadHandler.heKeyStates[0].pressed);
+    checkValue(key, 100 + key.rapidTriggerUpSensitivity);
+    TEST_ASSERT_FALSE(KeypadHandler.heKeyStates[0].pressed);
+
+    // Moving back down by the down sensitivity from the new peak presses it again.
+    checkValue(key, 100 + key.rapidTriggerUpSensitivity + 20);
+    checkValue(key, 100 + 20);
+    TEST_ASSERT_TRUE(KeypadHandler.heKeyStates[0].pressed);
+}
+
+void test_continuous_rapid_trigger_keeps_zone()
+{
+    // Above the upper hysteresis, the key can still be pressed by travelling down with continuous rapid trigger only.
+    HEKey key(0);
+    uint16_t top = key.upperHysteresis + 30;
+    for (bool continuous : {true, false})
+    {
+        setUp();
+        key.continuousRapidTrigger = continuous;
+        checkValue(key, key.lowerHysteresis);
+        checkValue(key, top + key.rapidTriggerDownSensitivity);
+        TEST_ASSERT_FALSE(KeypadHandler.heKeyStates[0].pressed);
+        checkValue(key, top);
+        TEST_ASSERT_EQUAL(continuous, KeypadHandler.heKeyStates[0].pressed);
+        tearDown();
+    }
+}
+
+void test_matches_reference_model()
+{
+    // Compare the firmware logic with the reference model on random configurations and trajectories, with a fixed seed so
+    // failures are reproducible. The seed and step of the first mismatch are part of the failure message.
+    std::mt19937 random(0x4D50);
+    static uint16_t values[1024];
+    char message[128];
+    for (uint16_t run = 0; run < 2000; run++)
+    {
+        setUp();
+        HEKey key = randomKey(random);
+        randomTrajectory(random, values, sizeof(values) / sizeof(*values));
+
+        ReferenceKey reference;
+        for (uint16_t i = 0; i < sizeof(values) / sizeof(*values); i++)
+        {
+            checkValue(key, values[i]);
+            reference.step(key, values[i]);
+            if (KeypadHandler.heKeyStates[0].pressed != reference.pressed)
+            {
+                snprintf(message, sizeof(message), "run %u step %u value %u rt %d crt %d rtus %u rtds %u lh %u uh %u", run, i, values[i],
+                         key.rapidTrigger, key.continuousRapidTrigger, key.rapidTriggerUpSensitivity, key.rapidTriggerDownSensitivity,
+                         key.lowerHysteresis, key.upperHysteresis);
+                TEST_FAIL_MESSAGE(message);
+            }
+        }
+
+        tearDown();
+    }
+}
+
+void test_invariants_hold()
+{
+    // Run random configurations and trajectories through the invariant checker, none of which may be violated.
+    std::mt19937 random(0x5254);
+    static uint16_t values[1024];
+    for (uint16_t run = 0; run < 2000; run++)
+    {
+        HEKey key = randomKey(random);
+        randomTrajectory(random, values, sizeof(values) / sizeof(*values));
+        for (uint16_t value : values)
+            checkValue(key, value);
+
+        // A fully released key is never pressed, whatever happened before.
+        checkValue(key, TRAVEL_DISTANCE_IN_0_01MM);
+        TEST_ASSERT_FALSE(KeypadHandler.heKeyStates[0].pressed);
+    }
+
+    for (uint8_t violation = 0; violation < RAPID_TRIGGER_VIOLATIONS; violation++)
+        TEST_ASSERT_EQUAL_UINT32(0, RapidTriggerChecker.violations[0][violation]);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_press_on_entering_zone);
+    RUN_TEST(test_release_and_press_by_sensitivity);
+    RUN_TEST(test_continuous_rapid_trigger_keeps_zone);
+    RUN_TEST(test_matches_reference_model);
+    RUN_TEST(test_invariants_hold);
+    return UNITY_END();
+}